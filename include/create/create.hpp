@@ -29,6 +29,9 @@
 
 #include "../container.hpp"
 
+#include <cstdint>
+#include <vector>
+
 namespace kdtree {
 
 template <typename T, T dim, 
@@ -40,6 +43,20 @@ requires kdtree::container::container<C>
 void
 create(kdtree::context& ctx, C& src, const N n);
 
+// adaptive build: every node splits along the axis in which its subtree has
+// the largest extent, and `dims[c]` records that axis for node `c` so that
+// queries can follow it (see nn and knn). leaves hold 0.
+template <typename T, T dim, 
+          kdtree::container::layout maj = kdtree::container::layout::row_major, 
+          typename C, typename N>
+requires kdtree::container::container<C> 
+      && std::is_integral_v<T>
+      && std::is_integral_v<N>
+      && (dim > 0 && static_cast<std::uintmax_t>(dim) <= 256)
+void
+create(kdtree::context& ctx, C& src, const N n,
+       std::vector<std::uint8_t>& dims);
+
 } // namespace kdtree
   
 ///////////////////////////////////////////////////////////////////////////////
@@ -56,67 +73,71 @@ create(kdtree::context& ctx, C& src, const N n);
 ///                                                                         ///
 ///////////////////////////////////////////////////////////////////////////////
 
-#include "internal/payload.hpp"
-#include "internal/F.hpp"
-
-#include "../internal/bsr.hpp"
-#include "../sort/sort.hpp"
+#include "internal/tuple.hpp"
+#include "internal/keyed.hpp"
+#include "internal/presort.hpp"
 
-#include "tags.hpp"
+#include "../internal/key.hpp"
 
-#define USE_BENCHMARK 0
+#include <limits>
 
-#if USE_BENCHMARK
-#include <chrono>
-#endif
+namespace kdtree   {
+namespace internal {
+namespace create   {
 
-template <typename T, T dim, kdtree::container::layout maj, 
-          typename C, typename N>
-requires kdtree::container::container<C> 
-      && std::is_integral_v<T>
-      && std::is_integral_v<N>
+template <typename T, T dim, kdtree::container::layout maj, typename C>
+requires kdtree::container::container<C> && std::is_integral_v<T>
 void
-kdtree::create(kdtree::context& ctx, C& src, const N n) {
-
-  using namespace kdtree::internal::create;
-
-  const T n_{static_cast<T>(n)};
-
-  std::vector<T> tag(n_, 0);
-
-  for (T l{0}; l < kdtree::internal::bsr(n_) + T{1}; ++l) {
+dispatch(const kdtree::context& ctx, C& src, const T n_, std::uint8_t* dims) {
 
-    #if USE_BENCHMARK
-    auto beg = std::chrono::high_resolution_clock::now();
-    #endif
+  using V = kdtree::container::get_primitive_t<C>;
 
-    {
-      const T d  {l % dim}; // TODO: template this away
-      const T n0 {0};
-      payload<T, dim, maj, decltype(src), decltype(tag)> p(src, tag, n_, d);
-      kdtree::sort(ctx, p, n0, n_);
+  if constexpr (kdtree::internal::key::encodable<V>) {
+    if (ctx.build == kdtree::builder::presort
+        && static_cast<std::uintmax_t>(n_) 
+                    <= std::numeric_limits<std::uint32_t>::max()) {
+      presort<T, dim, maj>(ctx, src, n_, dims);
+      return;
     }
+    if ((ctx.keys || ctx.sort == kdtree::sorter::radix)
+        && static_cast<std::uintmax_t>(n_) 
+                    <= std::numeric_limits<std::uint32_t>::max()) {
+      keyed<T, dim, maj>(ctx, src, n_, dims);
+      return;
+    }
+  }
 
-    #if USE_BENCHMARK
-    auto end = std::chrono::high_resolution_clock::now();
-    auto dur = std::chrono::duration_cast<std::chrono::milliseconds>(end - beg);
-    std::cout << "\t[sort] time: " << dur.count() << " ms" << std::endl;
-    #endif
-
-    #if USE_BENCHMARK
-    beg = std::chrono::high_resolution_clock::now();
-    #endif
+  tuple<T, dim, maj>(ctx, src, n_, dims);
 
-    tags::update(ctx, tag, n_, l);
+}
 
-    #if USE_BENCHMARK
-    end = std::chrono::high_resolution_clock::now();
-    dur = std::chrono::duration_cast<std::chrono::milliseconds>(end - beg);
-    std::cout << "\t[update] time: " << dur.count() << " ms" << std::endl;
-    #endif
+} // namespace create
+} // namespace internal
+} // namespace kdtree
 
-  }
+template <typename T, T dim, kdtree::container::layout maj, 
+          typename C, typename N>
+requires kdtree::container::container<C> 
+      && std::is_integral_v<T>
+      && std::is_integral_v<N>
+void
+kdtree::create(kdtree::context& ctx, C& src, const N n) {
+  kdtree::internal::create::dispatch<T, dim, maj>(ctx, src, static_cast<T>(n),
+                                                  nullptr);
+}
 
+template <typename T, T dim, kdtree::container::layout maj, 
+          typename C, typename N>
+requires kdtree::container::container<C> 
+      && std::is_integral_v<T>
+      && std::is_integral_v<N>
+      && (dim > 0 && static_cast<std::uintmax_t>(dim) <= 256)
+void
+kdtree::create(kdtree::context& ctx, C& src, const N n,
+               std::vector<std::uint8_t>& dims) {
+  dims.assign(static_cast<std::size_t>(n), std::uint8_t{0});
+  kdtree::internal::create::dispatch<T, dim, maj>(ctx, src, static_cast<T>(n),
+                                                  dims.data());
 }
 
 #endif // KDTREE_CREATE_HPP
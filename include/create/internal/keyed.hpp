@@ -0,0 +1,159 @@
+/*!
+ * \file        create/internal/keyed.hpp
+ * \author      Samridh D. Singh
+ * \date        2025-02-01
+ * \brief       kdtree create header and implementation
+ * \details     sorts packed coordinate keys and a 32-bit index permutation instead
+ *              of the point tuples, the points are gathered once at the end.
+ *
+ * \copyright   This file is part of the sycl_kdtree project.
+ * \copyright   Copyright (C) 2025, Samridh D. Singh
+ * \copyright   
+ *              sycl_kdtree is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License as
+ *              published by the Free Software Foundation, either version 3 of
+ *              the License, or (at your option) any later version.
+ *
+ *              sycl_kdtree is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *              GNU General Public License for more details.
+ *
+ *              A copy of the GNU General Public License should be provided
+ *              along with sycl_kdtree. 
+ *              If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef KDTREE_CREATE_INTERNAL_KEYED_HPP
+#define KDTREE_CREATE_INTERNAL_KEYED_HPP
+
+#include "../../container.hpp"
+#include "../../internal/key.hpp"
+
+namespace kdtree   {
+namespace internal {
+namespace create   {
+
+template <typename T, T dim, kdtree::container::layout maj, typename C>
+requires kdtree::container::container<C> && std::is_integral_v<T>
+      && kdtree::internal::key::encodable<kdtree::container::get_primitive_t<C>>
+void
+keyed(const kdtree::context& ctx, C& src, const T n,
+      std::uint8_t* dims = nullptr);
+
+} // namespace create
+} // namespace internal
+} // namespace kdtree
+
+///////////////////////////////////////////////////////////////////////////////
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                             IMPLEMENTATION                              ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "payload.hpp"
+#include "segments.hpp"
+#include "subtree.hpp"
+#include "widest.hpp"
+#include "F.hpp"
+
+#include "../tags.hpp"
+#include "../../internal/bsr.hpp"
+#include "../../sort/sort.hpp"
+#include "../../sort/select.hpp"
+#include "../../internal/lrchild.hpp"
+
+#include <cstdint>
+#include <vector>
+
+template <typename T, T dim, kdtree::container::layout maj, typename C>
+requires kdtree::container::container<C> && std::is_integral_v<T>
+      && kdtree::internal::key::encodable<kdtree::container::get_primitive_t<C>>
+void
+kdtree::internal::create::keyed(const kdtree::context& ctx, C& src, 
+                                const T n, std::uint8_t* dims) {
+
+  using kdtree::container::id;
+  using kdtree::internal::key::encode;
+  using kdtree::internal::l_child;
+
+  using V = kdtree::container::get_primitive_t<C>;
+  using K = kdtree::internal::key::type_t<V>;
+  using I = std::uint32_t;
+
+  std::vector<T> tag(n, 0);
+  std::vector<K> key(n);
+  std::vector<I> idx(n);
+
+  ctx.pool().parallel_for(T{0}, n, T{1} << 14, [&](const T i0, const T i1) {
+    for (T i{i0}; i < i1; ++i) id<T>(idx, n, i) = static_cast<I>(i);
+  });
+
+  // every segment holds a single tag (see tuple.hpp), so the key only needs
+  // the split coordinate and the tag array is not permuted by the sort.
+
+  const T L{kdtree::internal::bsr(n) + T{1}};
+
+  const auto split = [&](const T c, const T n0, const T n1) {
+    T d{kdtree::internal::bsr(c + T{1}) % dim};
+    if (dims) {
+      d = widest<T, dim, maj>(ctx, src, n, n0, n1, [&](const T i) {
+        return static_cast<T>(id<T>(idx, n, i));
+      });
+      dims[c] = static_cast<std::uint8_t>(d);
+    }
+    for (T i{n0}; i < n1; ++i) {
+      const T j{static_cast<T>(id<T>(idx, n, i))};
+      id<T>(key, n, i) = encode(id<T, dim, maj>(src, n, j, d));
+    }
+    key_payload<T, decltype(key), decltype(idx)> p(key, idx, n);
+    if (ctx.build == kdtree::builder::select) {
+      kdtree::select(ctx, p, n0, n0 + ss(l_child(c), n, L), n1);
+    } else {
+      kdtree::sort(ctx, p, n0, n1);
+    }
+  };
+
+  for (T l{0}; l < L; ++l) {
+
+    if (static_cast<std::size_t>(ss(F(l), n, L)) <= ctx.local) {
+      segments(ctx, n, l, [&](const T c, const T, const T) {
+        subtree(n, c, tag, split);
+      });
+      break;
+    }
+
+    segments(ctx, n, l, [&](const T c, const T n0, const T n1) {
+      split(c, n0, n1);
+      if (ctx.fuse) tags::update(tag, n, c, n0, n1);
+    });
+
+    if (!ctx.fuse) tags::update(ctx, tag, n, l);
+
+  }
+
+  // point `idx[i]` belongs to slot `tag[i]`; with that map finalize gathers
+  // the points into tree order in one walk.
+
+  {
+    std::vector<T> dst(n);
+    ctx.pool().parallel_for(T{0}, n, T{1} << 14, [&](const T i0, const T i1) {
+      for (T i{i0}; i < i1; ++i) {
+        id<T>(dst, n, static_cast<T>(id<T>(idx, n, i))) = id<T>(tag, n, i);
+      }
+    });
+    payload<T, dim, maj, C, decltype(dst)> p(src, dst, n, T{0});
+    tags::finalize(ctx, p, n);
+  }
+
+}
+
+#endif // KDTREE_CREATE_INTERNAL_KEYED_HPP
@@ -38,6 +38,11 @@ requires kdtree::container::container<C_src>
       && kdtree::container::container<C_tag>
 struct payload;
 
+template <typename T, typename C_key, typename C_idx>
+requires kdtree::container::container_1d<C_key>
+      && kdtree::container::container_1d<C_idx>
+struct key_payload;
+
 } // namespace create
 } // namespace internal
 } // namespace kdtree
@@ -103,4 +108,40 @@ struct kdtree::internal::create::payload {
 
 };
 
-#endif // KDTREE_CREATE_INTERNAL_SS_HPP
+// sorts (key, index) pairs only; the points themselves are gathered once the
+// permutation is known.
+
+template <typename T, typename C_key, typename C_idx>
+requires kdtree::container::container_1d<C_key>
+      && kdtree::container::container_1d<C_idx>
+struct kdtree::internal::create::key_payload {
+
+  C_key& key;
+  C_idx& idx;
+  const T n;
+
+  explicit key_payload(C_key& key_, C_idx& idx_, const T n_)
+    : key(key_), idx(idx_), n(n_) {}
+
+  template <typename int_t>
+  requires std::is_integral_v<int_t>
+  inline void
+  swap(const int_t i_, const int_t j_) {
+    kdtree::container::swap<int_t, int_t{1}, 
+                            kdtree::container::layout::row_major>(key, n, i_, j_);
+    kdtree::container::swap<int_t, int_t{1}, 
+                            kdtree::container::layout::row_major>(idx, n, i_, j_);
+  }
+
+  template <typename int_t>
+  requires std::is_integral_v<int_t>
+  inline bool
+  less(const int_t i_, const int_t j_) {
+    return kdtree::container::id<int_t>(key, n, i_)
+           <
+           kdtree::container::id<int_t>(key, n, j_);
+  }
+
+};
+
+#endif // KDTREE_CREATE_INTERNAL_PAYLOAD_HPP
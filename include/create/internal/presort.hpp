@@ -0,0 +1,183 @@
+/*!
+ * \file        create/internal/presort.hpp
+ * \author      Samridh D. Singh
+ * \date        2025-02-01
+ * \brief       kdtree create header and implementation
+ * \details     presorted-dimension engine: the points are sorted once per axis
+ *              and every level only partitions those orders stably.
+ *
+ * \copyright   This file is part of the sycl_kdtree project.
+ * \copyright   Copyright (C) 2025, Samridh D. Singh
+ * \copyright   
+ *              sycl_kdtree is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License as
+ *              published by the Free Software Foundation, either version 3 of
+ *              the License, or (at your option) any later version.
+ *
+ *              sycl_kdtree is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *              GNU General Public License for more details.
+ *
+ *              A copy of the GNU General Public License should be provided
+ *              along with sycl_kdtree. 
+ *              If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef KDTREE_CREATE_INTERNAL_PRESORT_HPP
+#define KDTREE_CREATE_INTERNAL_PRESORT_HPP
+
+#include "../../container.hpp"
+#include "../../internal/key.hpp"
+
+namespace kdtree   {
+namespace internal {
+namespace create   {
+
+template <typename T, T dim, kdtree::container::layout maj, typename C>
+requires kdtree::container::container<C> && std::is_integral_v<T>
+      && kdtree::internal::key::encodable<kdtree::container::get_primitive_t<C>>
+void
+presort(const kdtree::context& ctx, C& src, const T n,
+        std::uint8_t* dims = nullptr);
+
+} // namespace create
+} // namespace internal
+} // namespace kdtree
+
+///////////////////////////////////////////////////////////////////////////////
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                             IMPLEMENTATION                              ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "payload.hpp"
+#include "segments.hpp"
+#include "so.hpp"
+#include "ss.hpp"
+#include "widest.hpp"
+
+#include "../tags.hpp"
+#include "../../internal/bsr.hpp"
+#include "../../internal/lrchild.hpp"
+#include "../../sort/sort.hpp"
+
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+template <typename T, T dim, kdtree::container::layout maj, typename C>
+requires kdtree::container::container<C> && std::is_integral_v<T>
+      && kdtree::internal::key::encodable<kdtree::container::get_primitive_t<C>>
+void
+kdtree::internal::create::presort(const kdtree::context& ctx, C& src, 
+                                  const T n, std::uint8_t* dims) {
+
+  using kdtree::container::id;
+  using kdtree::internal::key::encode;
+  using kdtree::internal::l_child;
+  using kdtree::internal::r_child;
+
+  using V = kdtree::container::get_primitive_t<C>;
+  using K = kdtree::internal::key::type_t<V>;
+  using I = std::uint32_t;
+
+  const T L{kdtree::internal::bsr(n) + T{1}};
+
+  // `ord[e]` lists the point indices ordered by coordinate `e`. the segment
+  // of a node holds the same points in every list, so the split dimension
+  // picks its pivot by position and the other lists follow its tags.
+
+  std::array<std::vector<I>, dim> ord;
+  std::array<std::vector<I>, dim> buf;
+  std::vector<T> node(n, 0);
+
+  {
+    std::vector<K> key(n);
+    for (T e{0}; e < dim; ++e) {
+      ord[e].resize(n);
+      buf[e].resize(n);
+      ctx.pool().parallel_for(T{0}, n, T{1} << 14, 
+                              [&](const T i0, const T i1) {
+        for (T i{i0}; i < i1; ++i) {
+          id<T>(key, n, i)    = encode(id<T, dim, maj>(src, n, i, e));
+          id<T>(ord[e], n, i) = static_cast<I>(i);
+        }
+      });
+      key_payload<T, decltype(key), std::vector<I>> p(key, ord[e], n);
+      kdtree::sort(ctx, p, T{0}, n);
+    }
+  }
+
+  for (T l{0}; l < L; ++l) {
+
+    segments(ctx, n, l, [&](const T c, const T n0, const T n1) {
+
+      // the ends of every list bound the segment, so the widest axis of an
+      // adaptive build costs two reads per axis.
+
+      T d{l % dim};
+      if (dims) {
+        std::array<V, dim> lo;
+        std::array<V, dim> hi;
+        for (T e{0}; e < dim; ++e) {
+          const T j0{static_cast<T>(id<T>(ord[e], n, n0))};
+          const T j1{static_cast<T>(id<T>(ord[e], n, n1 - T{1}))};
+          lo[e] = id<T, dim, maj>(src, n, j0, e);
+          hi[e] = id<T, dim, maj>(src, n, j1, e);
+        }
+        d = widest<T, dim>(lo.data(), hi.data());
+        dims[c] = static_cast<std::uint8_t>(d);
+      }
+
+      const T p  { n0 + ss(l_child(c), n, L) };
+      const T lc { l_child(c)                };
+      const T rc { r_child(c)                };
+
+      for (T i{n0}; i < n1; ++i) {
+        const T j{static_cast<T>(id<T>(ord[d], n, i))};
+        id<T>(node, n, j) = (i < p) ? lc : (i > p) ? rc : c;
+      }
+
+      // stable, so every child segment stays sorted along each axis.
+
+      const T grain{(n1 - n0 >= (T{1} << 14)) ? T{1} : dim};
+      ctx.pool().parallel_for(T{0}, dim, grain, [&](const T e0, const T e1) {
+        for (T e{e0}; e < e1; ++e) {
+          T il{n0};
+          T ir{p + T{1}};
+          for (T i{n0}; i < n1; ++i) {
+            const I j { id<T>(ord[e], n, i)              };
+            const T t { id<T>(node, n, static_cast<T>(j)) };
+            if      (t == lc) id<T>(buf[e], n, il++) = j;
+            else if (t == rc) id<T>(buf[e], n, ir++) = j;
+            else              id<T>(buf[e], n, p)    = j;
+          }
+        }
+      });
+
+    });
+
+    std::swap(ord, buf);
+
+  }
+
+  // `node[j]` is the final slot of point `j`.
+
+  {
+    payload<T, dim, maj, C, decltype(node)> p(src, node, n, T{0});
+    tags::finalize(ctx, p, n);
+  }
+
+}
+
+#endif // KDTREE_CREATE_INTERNAL_PRESORT_HPP
@@ -0,0 +1,98 @@
+/*!
+ * \file        create/internal/segments.hpp
+ * \author      Samridh D. Singh
+ * \date        2025-02-01
+ * \brief       kdtree create header and implementation
+ * \details
+ *
+ * \copyright   This file is part of the sycl_kdtree project.
+ * \copyright   Copyright (C) 2025, Samridh D. Singh
+ * \copyright
+ *              sycl_kdtree is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License as
+ *              published by the Free Software Foundation, either version 3 of
+ *              the License, or (at your option) any later version.
+ *
+ *              sycl_kdtree is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *              GNU General Public License for more details.
+ *
+ *              A copy of the GNU General Public License should be provided
+ *              along with sycl_kdtree.
+ *              If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef KDTREE_CREATE_INTERNAL_SEGMENTS_HPP
+#define KDTREE_CREATE_INTERNAL_SEGMENTS_HPP
+
+#include "../../pch.hpp"
+
+namespace kdtree   {
+namespace internal {
+namespace create   {
+
+template <typename T, typename f_segment>
+requires std::is_integral_v<T>
+void
+segments(const kdtree::context& ctx, const T n, const T l, f_segment&& f);
+
+} // namespace create
+} // namespace internal
+} // namespace kdtree
+
+///////////////////////////////////////////////////////////////////////////////
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                             IMPLEMENTATION                              ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "F.hpp"
+#include "so.hpp"
+#include "ss.hpp"
+#include "../../internal/bsr.hpp"
+#include "../../internal/minmax.hpp"
+
+// calls `f(c, n0, n1)` for every node `c` on level `l` whose segment
+// [n0, n1) holds more than one element. the segments are disjoint and are
+// handed to the pool in runs of roughly `grain` elements; `f` may use the
+// pool itself for large segments.
+
+template <typename T, typename f_segment>
+requires std::is_integral_v<T>
+void
+kdtree::internal::create::segments(const kdtree::context& ctx,
+                                   const T n, const T l, f_segment&& f) {
+
+  using kdtree::internal::bsr;
+  using kdtree::internal::min;
+  using kdtree::internal::max;
+
+  constexpr T grain{T{1} << 12};
+
+  const T L  { bsr(n) + T{1}          };
+  const T c0 { F(l)                   };
+  const T nc { min(T{1} << l, n - c0) };
+  const T w  { max(T{1}, grain / max(T{1}, ss(c0, n, L))) };
+
+  ctx.pool().parallel_for(c0, c0 + nc, w, [&](const T c0_, const T c1_) {
+    for (T c{c0_}; c < c1_; ++c) {
+      const T n0 { so(c, n, L)      };
+      const T n1 { n0 + ss(c, n, L) };
+      if (n1 - n0 > T{1}) {
+        f(c, n0, n1);
+      }
+    }
+  });
+
+}
+
+#endif // KDTREE_CREATE_INTERNAL_SEGMENTS_HPP
@@ -0,0 +1,77 @@
+/*!
+ * \file        create/internal/so.hpp
+ * \author      Samridh D. Singh
+ * \date        2025-02-01
+ * \brief       kdtree create header and implementation
+ * \details     in-order offset of the segment holding subtree `s` while the
+ *              tree is built in place (pivots are not moved to the front).
+ *
+ * \copyright   This file is part of the sycl_kdtree project.
+ * \copyright   Copyright (C) 2025, Samridh D. Singh
+ * \copyright
+ *              sycl_kdtree is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License as
+ *              published by the Free Software Foundation, either version 3 of
+ *              the License, or (at your option) any later version.
+ *
+ *              sycl_kdtree is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *              GNU General Public License for more details.
+ *
+ *              A copy of the GNU General Public License should be provided
+ *              along with sycl_kdtree.
+ *              If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef KDTREE_CREATE_INTERNAL_SO_HPP
+#define KDTREE_CREATE_INTERNAL_SO_HPP
+
+namespace kdtree   {
+namespace internal {
+namespace create   {
+
+template <typename T>
+requires std::is_integral_v<T>
+constexpr inline T
+so(const T s, const T n, const T L);
+
+} // namespace create
+} // namespace internal
+} // namespace kdtree
+
+///////////////////////////////////////////////////////////////////////////////
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                             IMPLEMENTATION                              ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "F.hpp"
+#include "sb.hpp"
+#include "../../internal/bsr.hpp"
+
+template <typename T>
+requires std::is_integral_v<T>
+constexpr inline T
+kdtree::internal::create::so(const T s, const T n, const T L) {
+
+  using kdtree::internal::bsr;
+
+  // every level above `l` is complete, so the in-order position of subtree
+  // `s` is the size of the subtrees to its left on level `l` (sb - F) plus
+  // the one ancestor-level node sitting between each pair of them (s - F).
+
+  const T l { bsr(s+1) };
+  return sb(s, n, L) - F(l) + s - F(l);
+
+}
+
+#endif // KDTREE_CREATE_INTERNAL_SO_HPP
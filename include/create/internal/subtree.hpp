@@ -0,0 +1,98 @@
+/*!
+ * \file        create/internal/subtree.hpp
+ * \author      Samridh D. Singh
+ * \date        2025-02-01
+ * \brief       kdtree create header and implementation
+ * \details     serial build of a whole subtree inside its own segment, used
+ *              once the segments of a level fit in cache.
+ *
+ * \copyright   This file is part of the sycl_kdtree project.
+ * \copyright   Copyright (C) 2025, Samridh D. Singh
+ * \copyright   
+ *              sycl_kdtree is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License as
+ *              published by the Free Software Foundation, either version 3 of
+ *              the License, or (at your option) any later version.
+ *
+ *              sycl_kdtree is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *              GNU General Public License for more details.
+ *
+ *              A copy of the GNU General Public License should be provided
+ *              along with sycl_kdtree. 
+ *              If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef KDTREE_CREATE_INTERNAL_SUBTREE_HPP
+#define KDTREE_CREATE_INTERNAL_SUBTREE_HPP
+
+#include "../../container.hpp"
+
+namespace kdtree   {
+namespace internal {
+namespace create   {
+
+template <typename T, typename C_tag, typename f_split>
+requires kdtree::container::container<C_tag> && std::is_integral_v<T>
+void
+subtree(const T n, const T s, C_tag& tag, f_split&& split);
+
+} // namespace create
+} // namespace internal
+} // namespace kdtree
+
+///////////////////////////////////////////////////////////////////////////////
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                             IMPLEMENTATION                              ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "so.hpp"
+#include "ss.hpp"
+#include "../../internal/bsr.hpp"
+#include "../../internal/lrchild.hpp"
+
+// builds subtree `s` depth first without touching anything outside its
+// segment. `split(c, n0, n1)` must place the pivot of node `c` at
+// n0 + ss(l_child(c)) with the smaller elements before it; the tag of every
+// pivot is set to its node, as tags::update would have done level by level.
+
+template <typename T, typename C_tag, typename f_split>
+requires kdtree::container::container<C_tag> && std::is_integral_v<T>
+void
+kdtree::internal::create::subtree(const T n, const T s, C_tag& tag, 
+                                  f_split&& split) {
+
+  using kdtree::internal::bsr;
+  using kdtree::internal::l_child;
+  using kdtree::internal::r_child;
+
+  if (s >= n) {
+    return;
+  }
+
+  const T L  { bsr(n) + T{1}                 };
+  const T n0 { so(s, n, L)                   };
+  const T n1 { n0 + ss(s, n, L)              };
+  const T p  { n0 + ss(l_child(s), n, L)     };
+
+  if (n1 - n0 > T{1}) {
+    split(s, n0, n1);
+  }
+  kdtree::container::id<T>(tag, n, p) = s;
+
+  subtree(n, l_child(s), tag, split);
+  subtree(n, r_child(s), tag, split);
+
+}
+
+#endif // KDTREE_CREATE_INTERNAL_SUBTREE_HPP
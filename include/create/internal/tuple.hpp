@@ -0,0 +1,165 @@
+/*!
+ * \file        create/internal/tuple.hpp
+ * \author      Samridh D. Singh
+ * \date        2025-02-01
+ * \brief       kdtree create header and implementation
+ * \details     sorts the full point tuples level by level.
+ *
+ * \copyright   This file is part of the sycl_kdtree project.
+ * \copyright   Copyright (C) 2025, Samridh D. Singh
+ * \copyright   
+ *              sycl_kdtree is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License as
+ *              published by the Free Software Foundation, either version 3 of
+ *              the License, or (at your option) any later version.
+ *
+ *              sycl_kdtree is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *              GNU General Public License for more details.
+ *
+ *              A copy of the GNU General Public License should be provided
+ *              along with sycl_kdtree. 
+ *              If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef KDTREE_CREATE_INTERNAL_TUPLE_HPP
+#define KDTREE_CREATE_INTERNAL_TUPLE_HPP
+
+#include "../../container.hpp"
+
+#include <cstdint>
+
+namespace kdtree   {
+namespace internal {
+namespace create   {
+
+template <typename T, T dim, kdtree::container::layout maj, typename C>
+requires kdtree::container::container<C> && std::is_integral_v<T>
+void
+tuple(const kdtree::context& ctx, C& src, const T n,
+      std::uint8_t* dims = nullptr);
+
+} // namespace create
+} // namespace internal
+} // namespace kdtree
+
+///////////////////////////////////////////////////////////////////////////////
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                             IMPLEMENTATION                              ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "payload.hpp"
+#include "segments.hpp"
+#include "subtree.hpp"
+#include "widest.hpp"
+#include "F.hpp"
+
+#include "../tags.hpp"
+#include "../../internal/bsr.hpp"
+#include "../../sort/sort.hpp"
+#include "../../sort/select.hpp"
+#include "../../internal/lrchild.hpp"
+
+#include <vector>
+
+#define USE_BENCHMARK 0
+
+#if USE_BENCHMARK
+#include <chrono>
+#include <iostream>
+#endif
+
+template <typename T, T dim, kdtree::container::layout maj, typename C>
+requires kdtree::container::container<C> && std::is_integral_v<T>
+void
+kdtree::internal::create::tuple(const kdtree::context& ctx, C& src, 
+                                const T n, std::uint8_t* dims) {
+
+  using kdtree::internal::l_child;
+
+  std::vector<T> tag(n, 0);
+
+  // subtrees are built in place: the segment of a node stays where its
+  // parent's sort left it, so only [so(c), so(c) + ss(c)) is sorted for each
+  // node `c` of the level and finished nodes are never touched again. the
+  // nodes are moved to their left-balanced slots once, after the last level.
+  // the level only needs the pivot of each segment in place with the smaller
+  // elements before it, so builder::select partitions instead of sorting.
+  // with `dims` every node splits along the widest axis of its segment and
+  // records it there instead of cycling through the axes by level.
+
+  const T L{kdtree::internal::bsr(n) + T{1}};
+
+  const auto split = [&](const T c, const T n0, const T n1) {
+    T d{kdtree::internal::bsr(c + T{1}) % dim};
+    if (dims) {
+      d = widest<T, dim, maj>(ctx, src, n, n0, n1, [](const T i) { return i; });
+      dims[c] = static_cast<std::uint8_t>(d);
+    }
+    payload<T, dim, maj, C, decltype(tag)> p(src, tag, n, d);
+    if (ctx.build == kdtree::builder::select) {
+      kdtree::select(ctx, p, n0, n0 + ss(l_child(c), n, L), n1);
+    } else {
+      kdtree::sort(ctx, p, n0, n1);
+    }
+  };
+
+  for (T l{0}; l < L; ++l) {
+
+    // once the largest segment of the level fits in ctx.local, every
+    // remaining subtree is finished by one task instead of one pass per level.
+
+    if (static_cast<std::size_t>(ss(F(l), n, L)) <= ctx.local) {
+      segments(ctx, n, l, [&](const T c, const T, const T) {
+        subtree(n, c, tag, split);
+      });
+      break;
+    }
+
+    #if USE_BENCHMARK
+    auto beg = std::chrono::high_resolution_clock::now();
+    #endif
+
+    segments(ctx, n, l, [&](const T c, const T n0, const T n1) {
+      split(c, n0, n1);
+      if (ctx.fuse) tags::update(tag, n, c, n0, n1);
+    });
+
+    #if USE_BENCHMARK
+    auto end = std::chrono::high_resolution_clock::now();
+    auto dur = std::chrono::duration_cast<std::chrono::milliseconds>(end - beg);
+    std::cout << "\t[sort] time: " << dur.count() << " ms" << std::endl;
+    #endif
+
+    #if USE_BENCHMARK
+    beg = std::chrono::high_resolution_clock::now();
+    #endif
+
+    if (!ctx.fuse) tags::update(ctx, tag, n, l);
+
+    #if USE_BENCHMARK
+    end = std::chrono::high_resolution_clock::now();
+    dur = std::chrono::duration_cast<std::chrono::milliseconds>(end - beg);
+    std::cout << "\t[update] time: " << dur.count() << " ms" << std::endl;
+    #endif
+
+  }
+
+  {
+    payload<T, dim, maj, C, decltype(tag)> p(src, tag, n, T{0});
+    tags::finalize(ctx, p, n);
+  }
+
+}
+
+#endif // KDTREE_CREATE_INTERNAL_TUPLE_HPP
@@ -0,0 +1,138 @@
+/*!
+ * \file        create/internal/widest.hpp
+ * \author      Samridh D. Singh
+ * \date        2025-02-01
+ * \brief       kdtree create header and implementation
+ * \details     axis of largest extent of a segment, used as the split
+ *              dimension of adaptive builds.
+ *
+ * \copyright   This file is part of the sycl_kdtree project.
+ * \copyright   Copyright (C) 2025, Samridh D. Singh
+ * \copyright
+ *              sycl_kdtree is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License as
+ *              published by the Free Software Foundation, either version 3 of
+ *              the License, or (at your option) any later version.
+ *
+ *              sycl_kdtree is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *              GNU General Public License for more details.
+ *
+ *              A copy of the GNU General Public License should be provided
+ *              along with sycl_kdtree.
+ *              If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef KDTREE_CREATE_INTERNAL_WIDEST_HPP
+#define KDTREE_CREATE_INTERNAL_WIDEST_HPP
+
+#include "../../pch.hpp"
+#include "../../container.hpp"
+
+namespace kdtree   {
+namespace internal {
+namespace create   {
+
+// returns the axis along which the points `row(i)`, i in [n0, n1), spread the
+// most; ties go to the lowest axis.
+template <typename T, T dim, kdtree::container::layout maj, typename C,
+          typename f_row>
+requires kdtree::container::container<C> && std::is_integral_v<T>
+T
+widest(const kdtree::context& ctx, const C& src, const T n,
+       const T n0, const T n1, f_row&& row);
+
+// same, from the per-axis bounds `lo[e]` and `hi[e]` of a segment.
+template <typename T, T dim, typename V>
+requires std::is_integral_v<T> && std::is_arithmetic_v<V>
+constexpr T
+widest(const V* lo, const V* hi);
+
+} // namespace create
+} // namespace internal
+} // namespace kdtree
+
+///////////////////////////////////////////////////////////////////////////////
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                             IMPLEMENTATION                              ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///////////////////////////////////////////////////////////////////////////////
+
+#include <array>
+#include <mutex>
+
+template <typename T, T dim, typename V>
+requires std::is_integral_v<T> && std::is_arithmetic_v<V>
+constexpr T
+kdtree::internal::create::widest(const V* lo, const V* hi) {
+
+  // the difference is taken in double so that wide integer ranges cannot
+  // overflow; only the order of the extents matters.
+
+  T d{0};
+  double w{static_cast<double>(hi[0]) - static_cast<double>(lo[0])};
+  for (T e{1}; e < dim; ++e) {
+    const double x{static_cast<double>(hi[e]) - static_cast<double>(lo[e])};
+    if (x > w) { w = x; d = e; }
+  }
+  return d;
+
+}
+
+template <typename T, T dim, kdtree::container::layout maj, typename C,
+          typename f_row>
+requires kdtree::container::container<C> && std::is_integral_v<T>
+T
+kdtree::internal::create::widest(const kdtree::context& ctx, const C& src,
+                                 const T n, const T n0, const T n1,
+                                 f_row&& row) {
+
+  using kdtree::container::id;
+  using V = kdtree::container::get_primitive_t<C>;
+
+  std::array<V, dim> lo;
+  std::array<V, dim> hi;
+  for (T e{0}; e < dim; ++e) {
+    lo[e] = hi[e] = id<T, dim, maj>(src, n, row(n0), e);
+  }
+
+  // the segments of the top levels are large, so their bounds are reduced
+  // by the pool in chunks that each start from their own first point.
+
+  std::mutex m;
+  const T grain{T{1} << 14};
+  ctx.pool().parallel_for(n0, n1, grain, [&](const T i0, const T i1) {
+    std::array<V, dim> lo_;
+    std::array<V, dim> hi_;
+    for (T e{0}; e < dim; ++e) {
+      lo_[e] = hi_[e] = id<T, dim, maj>(src, n, row(i0), e);
+    }
+    for (T i{i0}; i < i1; ++i) {
+      const T j{row(i)};
+      for (T e{0}; e < dim; ++e) {
+        const V x{id<T, dim, maj>(src, n, j, e)};
+        if (x < lo_[e]) lo_[e] = x;
+        if (x > hi_[e]) hi_[e] = x;
+      }
+    }
+    std::lock_guard<std::mutex> lk(m);
+    for (T e{0}; e < dim; ++e) {
+      if (lo_[e] < lo[e]) lo[e] = lo_[e];
+      if (hi_[e] > hi[e]) hi[e] = hi_[e];
+    }
+  });
+
+  return widest<T, dim>(lo.data(), hi.data());
+
+}
+
+#endif // KDTREE_CREATE_INTERNAL_WIDEST_HPP
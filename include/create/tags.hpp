@@ -26,6 +26,9 @@
 #ifndef KDTREE_CREATE_TAG_HPP
 #define KDTREE_CREATE_TAG_HPP
 
+#include "../pch.hpp"
+#include "../container.hpp"
+
 namespace kdtree   {
 namespace internal {
 namespace create   {
@@ -36,6 +39,16 @@ requires kdtree::container::container<C> && std::is_integral_v<T>
 void
 update(const kdtree::context& ctx, C& arr, const T n, const T l); 
 
+template <typename C, typename T>
+requires kdtree::container::container<C> && std::is_integral_v<T>
+void
+update(C& arr, const T n, const T c, const T n0, const T n1); 
+
+template <typename payload_t, typename T>
+requires std::is_integral_v<T>
+void
+finalize(const kdtree::context& ctx, payload_t& p, const T n);
+
 } // namespace tag
 } // namespace create
 } // namespace internal
@@ -56,10 +69,13 @@ update(const kdtree::context& ctx, C& arr, const T n, const T l);
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "internal/ss.hpp"
-#include "internal/sb.hpp"
+#include "internal/so.hpp"
 #include "internal/F.hpp"
 #include "../internal/lrchild.hpp"
 #include "../internal/bsr.hpp"
+#include "../internal/minmax.hpp"
+
+#include <vector>
 
 template <typename C, typename T>
 requires kdtree::container::container<C> && std::is_integral_v<T>
@@ -71,34 +87,87 @@ kdtree::internal::create::tags::update(const kdtree::context& ctx,
   using kdtree::internal::l_child;
   using kdtree::internal::r_child;
   using kdtree::internal::bsr;
+  using kdtree::internal::min;
 
-  (void) ctx;
+  const T L  { bsr(n)+1                    };
+  const T c0 { F(l)                        };
+  const T nc { min(T{1} << l, n - c0)      };
+
+  // a level has at most 2^l distinct tags, so the pivot of each is looked up
+  // instead of being recomputed for every element.
 
-  (void) l;
-  
-  const T L{bsr(n)+1};
+  std::vector<T> piv(nc);
+  ctx.pool().parallel_for(T{0}, nc, T{1} << 12, [&](const T i0, const T i1) {
+    for (T i{i0}; i < i1; ++i) {
+      const T c{c0 + i};
+      piv[i] = so(c, n, L) + ss(l_child(c), n, L);
+    }
+  });
 
-  for (T i{F(l)}; i < n; ++i) {
+  ctx.pool().parallel_for(T{0}, n, T{1} << 14, [&](const T i0, const T i1) {
 
-    const T c{arr[i]};
-    const T p{sb(c, n, L) + ss(l_child(c), n, L)};
+    for (T i{i0}; i < i1; ++i) {
+
+      const T c{kdtree::container::id<T>(arr, n, i)};
+      if (c < c0) {
+        continue;
+      }
+
+      const T p{piv[c - c0]};
+
+      if (i < p) {
+        kdtree::container::id<T>(arr, n, i) = l_child(c);
+      } else if (i > p) {
+        kdtree::container::id<T>(arr, n, i) = r_child(c);
+      } else {
+      }
 
-#if 0
-    if (i < p) {
-      arr[i] = l_child(c);
-    } else if (i > p) {
-      arr[i] = r_child(c);
-    } else {
-    }
-#else
-    if (i < p) {
-      kdtree::container::id<T>(arr, n, i) = l_child(c);
-    } else if (i > p) {
-      kdtree::container::id<T>(arr, n, i) = r_child(c);
-    } else {
     }
-#endif
 
+  });
+
+}
+
+// retags the segment [n0, n1) of node `c` right after it has been split,
+// while it is still in cache. every slot of the segment holds tag `c`.
+
+template <typename C, typename T>
+requires kdtree::container::container<C> && std::is_integral_v<T>
+void
+kdtree::internal::create::tags::update(C& arr, const T n, const T c, 
+                                       const T n0, const T n1) {
+
+  using kdtree::internal::l_child;
+  using kdtree::internal::r_child;
+  using kdtree::internal::bsr;
+
+  const T L { bsr(n)+1                       };
+  const T p { n0 + ss(l_child(c), n, L)      };
+
+  for (T i{n0}; i < p; ++i) {
+    kdtree::container::id<T>(arr, n, i) = l_child(c);
+  }
+  for (T i{p + T{1}}; i < n1; ++i) {
+    kdtree::container::id<T>(arr, n, i) = r_child(c);
+  }
+
+}
+
+template <typename payload_t, typename T>
+requires std::is_integral_v<T>
+void
+kdtree::internal::create::tags::finalize(const kdtree::context& ctx,
+                                         payload_t& p, const T n) {
+
+  (void) ctx;
+
+  // every slot now carries the id of the node it holds, which is also its
+  // index in the left-balanced layout. one cycle walk places all of them.
+
+  for (T i{0}; i < n; ++i) {
+    while (kdtree::container::id<T>(p.tag, n, i) != i) {
+      p.swap(i, kdtree::container::id<T>(p.tag, n, i));
+    }
   }
 
 }
@@ -0,0 +1,105 @@
+/*!
+ * \file        internal/key.hpp
+ * \author      Samridh D. Singh
+ * \date        2025-02-01
+ * \brief       order preserving unsigned sort keys
+ * \details     maps an arithmetic value onto an unsigned integer of at least
+ *              its width such that `a < b` implies `encode(a) < encode(b)`.
+ *
+ * \copyright   This file is part of the sycl_kdtree project.
+ * \copyright   Copyright (C) 2025, Samridh D. Singh
+ * \copyright
+ *              sycl_kdtree is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License as
+ *              published by the Free Software Foundation, either version 3 of
+ *              the License, or (at your option) any later version.
+ *
+ *              sycl_kdtree is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *              GNU General Public License for more details.
+ *
+ *              A copy of the GNU General Public License should be provided
+ *              along with sycl_kdtree.
+ *              If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef KDTREE_INTERNAL_KEY_HPP
+#define KDTREE_INTERNAL_KEY_HPP
+
+#include "../pch.hpp"
+
+#include <bit>
+#include <climits>
+#include <cstdint>
+
+namespace kdtree   {
+namespace internal {
+namespace key      {
+
+template <typename V>
+concept encodable = std::is_arithmetic_v<V> && (sizeof(V) <= 8)
+                 && (!std::is_floating_point_v<V> || sizeof(V) >= 4);
+
+template <typename V>
+requires encodable<V>
+using type_t = std::conditional_t<(sizeof(V) <= 4), std::uint32_t,
+                                                    std::uint64_t>;
+
+template <typename V>
+requires encodable<V>
+constexpr inline type_t<V>
+encode(const V v);
+
+} // namespace key
+} // namespace internal
+} // namespace kdtree
+
+///////////////////////////////////////////////////////////////////////////////
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                             IMPLEMENTATION                              ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename V>
+requires kdtree::internal::key::encodable<V>
+constexpr inline kdtree::internal::key::type_t<V>
+kdtree::internal::key::encode(const V v) {
+
+  using K = type_t<V>;
+
+  if constexpr (std::is_floating_point_v<V>) {
+
+    // negative values have every bit flipped so that larger magnitudes sort
+    // first, positive values only get the sign bit set.
+
+    using U = std::conditional_t<(sizeof(V) == 4), std::uint32_t,
+                                                   std::uint64_t>;
+    constexpr U msb { U{1} << (CHAR_BIT * sizeof(U) - 1) };
+    const U b { std::bit_cast<U>(v) };
+    const U m { (b & msb) ? ~U{0} : msb };
+    return static_cast<K>(b ^ m);
+
+  } else if constexpr (std::is_signed_v<V>) {
+
+    using U = std::make_unsigned_t<V>;
+    constexpr U msb { static_cast<U>(U{1} << (CHAR_BIT * sizeof(U) - 1)) };
+    return static_cast<K>(static_cast<U>(static_cast<U>(v) ^ msb));
+
+  } else {
+
+    return static_cast<K>(v);
+
+  }
+
+}
+
+#endif // KDTREE_INTERNAL_KEY_HPP
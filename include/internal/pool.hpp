@@ -0,0 +1,322 @@
+/*!
+ * \file        internal/pool.hpp
+ * \author      Samridh D. Singh
+ * \date        2025-02-01
+ * \brief       persistent work-stealing thread pool
+ * \details     every worker owns a deque; it pops its own work from the back
+ *              and steals from the front of the others. threads that wait on
+ *              a fork-join keep executing tasks, so nested parallel regions
+ *              never block a worker.
+ *
+ * \copyright   This file is part of the sycl_kdtree project.
+ * \copyright   Copyright (C) 2025, Samridh D. Singh
+ * \copyright
+ *              sycl_kdtree is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License as
+ *              published by the Free Software Foundation, either version 3 of
+ *              the License, or (at your option) any later version.
+ *
+ *              sycl_kdtree is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *              GNU General Public License for more details.
+ *
+ *              A copy of the GNU General Public License should be provided
+ *              along with sycl_kdtree.
+ *              If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef KDTREE_INTERNAL_POOL_HPP
+#define KDTREE_INTERNAL_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace kdtree   {
+namespace internal {
+
+class pool {
+
+public:
+
+  explicit pool(const std::size_t nthreads);
+  ~pool();
+
+  pool(const pool&)            = delete;
+  pool& operator=(const pool&) = delete;
+
+  // number of threads taking part in a parallel region, the caller included.
+  std::size_t
+  size() const noexcept;
+
+  // runs `a` and `b` in parallel and returns once both have finished.
+  template <typename F_a, typename F_b>
+  void
+  invoke(F_a&& a, F_b&& b);
+
+  // calls `f(i0, i1)` on chunks of at most `grain` indices of [n0, n1).
+  // chunks are handed out dynamically to up to size() threads; a pool of
+  // one thread calls `f(n0, n1)` once.
+  template <typename T, typename F>
+  requires std::is_integral_v<T>
+  void
+  parallel_for(const T n0, const T n1, const T grain, F&& f);
+
+private:
+
+  struct group;
+  struct alignas(64) queue {
+    std::mutex                        m;
+    std::deque<std::function<void()>> q;
+  };
+
+  void spawn(group& g, std::function<void()> f);
+  void wait(group& g);
+  bool help(const std::size_t i);
+  void work(const std::size_t i);
+  std::size_t self() const noexcept;
+
+  std::vector<std::unique_ptr<queue>> queues;
+  std::vector<std::thread>            workers;
+
+  std::atomic<std::size_t> pending{0};
+  std::mutex               m;
+  std::condition_variable  cv;
+  bool                     stop{false};
+
+};
+
+} // namespace internal
+} // namespace kdtree
+
+///////////////////////////////////////////////////////////////////////////////
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                             IMPLEMENTATION                              ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///////////////////////////////////////////////////////////////////////////////
+
+struct kdtree::internal::pool::group {
+  std::atomic<std::size_t> count{0};
+  std::atomic<bool>        failed{false};
+  std::exception_ptr       error;
+};
+
+namespace kdtree   {
+namespace internal {
+namespace pool_    {
+
+struct worker_t {
+  const kdtree::internal::pool* p;
+  std::size_t                   i;
+};
+
+inline thread_local worker_t worker{nullptr, 0};
+
+} // namespace pool_
+} // namespace internal
+} // namespace kdtree
+
+inline
+kdtree::internal::pool::pool(const std::size_t nthreads) {
+
+  const std::size_t nt{nthreads > 0 ? nthreads : 1};
+
+  // queue 0 is shared by every thread that is not a worker of this pool.
+  queues.reserve(nt);
+  for (std::size_t i{0}; i < nt; ++i) {
+    queues.push_back(std::make_unique<queue>());
+  }
+
+  workers.reserve(nt - 1);
+  for (std::size_t i{1}; i < nt; ++i) {
+    workers.emplace_back([this, i] { work(i); });
+  }
+
+}
+
+inline
+kdtree::internal::pool::~pool() {
+  {
+    std::lock_guard<std::mutex> lk(m);
+    stop = true;
+  }
+  cv.notify_all();
+  for (auto& w : workers) w.join();
+}
+
+inline std::size_t
+kdtree::internal::pool::size() const noexcept {
+  return queues.size();
+}
+
+inline std::size_t
+kdtree::internal::pool::self() const noexcept {
+  return (pool_::worker.p == this) ? pool_::worker.i : 0;
+}
+
+inline void
+kdtree::internal::pool::spawn(group& g, std::function<void()> f) {
+
+  g.count.fetch_add(1, std::memory_order_relaxed);
+
+  auto t = [&g, f = std::move(f)] {
+    try {
+      f();
+    } catch (...) {
+      if (!g.failed.exchange(true)) g.error = std::current_exception();
+    }
+    g.count.fetch_sub(1, std::memory_order_release);
+  };
+
+  {
+    queue& q{*queues[self()]};
+    std::lock_guard<std::mutex> lk(q.m);
+    q.q.emplace_back(std::move(t));
+  }
+
+  pending.fetch_add(1, std::memory_order_release);
+  { std::lock_guard<std::mutex> lk(m); }
+  cv.notify_one();
+
+}
+
+inline bool
+kdtree::internal::pool::help(const std::size_t i) {
+
+  std::function<void()> t;
+
+  const std::size_t nq{queues.size()};
+  for (std::size_t k{0}; k < nq && !t; ++k) {
+    queue& q{*queues[(i + k) % nq]};
+    std::lock_guard<std::mutex> lk(q.m);
+    if (q.q.empty()) continue;
+    if (k == 0) { t = std::move(q.q.back());  q.q.pop_back();  }
+    else        { t = std::move(q.q.front()); q.q.pop_front(); }
+    pending.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  if (!t) return false;
+  t();
+  return true;
+
+}
+
+inline void
+kdtree::internal::pool::wait(group& g) {
+
+  const std::size_t i{self()};
+  while (g.count.load(std::memory_order_acquire) > 0) {
+    if (!help(i)) std::this_thread::yield();
+  }
+
+  if (g.failed.load()) std::rethrow_exception(g.error);
+
+}
+
+inline void
+kdtree::internal::pool::work(const std::size_t i) {
+
+  pool_::worker = {this, i};
+
+  while (1) {
+    if (help(i)) continue;
+    std::unique_lock<std::mutex> lk(m);
+    cv.wait(lk, [&] {
+      return stop || pending.load(std::memory_order_acquire) > 0;
+    });
+    if (stop) return;
+  }
+
+}
+
+template <typename F_a, typename F_b>
+void
+kdtree::internal::pool::invoke(F_a&& a, F_b&& b) {
+
+  if (size() < 2) {
+    a();
+    b();
+    return;
+  }
+
+  group g;
+  spawn(g, [&b] { b(); });
+
+  try {
+    a();
+  } catch (...) {
+    g.failed = true;
+    while (g.count.load(std::memory_order_acquire) > 0) {
+      if (!help(self())) std::this_thread::yield();
+    }
+    throw;
+  }
+
+  wait(g);
+
+}
+
+template <typename T, typename F>
+requires std::is_integral_v<T>
+void
+kdtree::internal::pool::parallel_for(const T n0, const T n1, const T grain,
+                                     F&& f) {
+
+  if (n1 <= n0) return;
+
+  const std::size_t n { static_cast<std::size_t>(n1 - n0)                 };
+  const std::size_t w { grain > T{0} ? static_cast<std::size_t>(grain) : 1 };
+  const std::size_t nc{ (n + w - 1) / w                                    };
+
+  if (nc < 2 || size() < 2) {
+    f(n0, n1);
+    return;
+  }
+
+  std::atomic<std::size_t> next{0};
+
+  const auto body = [&] {
+    for (std::size_t c{next.fetch_add(1)}; c < nc; c = next.fetch_add(1)) {
+      const T i0 { static_cast<T>(n0 + static_cast<T>(c * w)) };
+      const T i1 { static_cast<T>(c + 1 < nc ? i0 + static_cast<T>(w) : n1) };
+      f(i0, i1);
+    }
+  };
+
+  const std::size_t nt{nc < size() ? nc : size()};
+
+  group g;
+  for (std::size_t t{1}; t < nt; ++t) spawn(g, body);
+
+  try {
+    body();
+  } catch (...) {
+    next = nc;
+    while (g.count.load(std::memory_order_acquire) > 0) {
+      if (!help(self())) std::this_thread::yield();
+    }
+    throw;
+  }
+
+  wait(g);
+
+}
+
+#endif // KDTREE_INTERNAL_POOL_HPP
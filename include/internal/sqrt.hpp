@@ -0,0 +1,77 @@
+/*!
+ * \file        internal/sqrt.hpp
+ * \author      Samridh D. Singh
+ * \date        2025-02-01
+ * \brief       square root usable in host and device code
+ * \details     integral arguments are rounded down.
+ *
+ * \copyright   This file is part of the sycl_kdtree project.
+ * \copyright   Copyright (C) 2025, Samridh D. Singh
+ * \copyright   
+ *              sycl_kdtree is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License as
+ *              published by the Free Software Foundation, either version 3 of
+ *              the License, or (at your option) any later version.
+ *
+ *              sycl_kdtree is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *              GNU General Public License for more details.
+ *
+ *              A copy of the GNU General Public License should be provided
+ *              along with sycl_kdtree. 
+ *              If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef KDTREE_INTERNAL_SQRT_HPP
+#define KDTREE_INTERNAL_SQRT_HPP
+
+#include <type_traits>
+
+namespace kdtree   {
+namespace internal {
+
+template <typename T>
+requires std::is_arithmetic_v<T>
+inline T
+sqrt(const T n);
+
+} // namespace kdtree
+} // namespace internal
+ 
+///////////////////////////////////////////////////////////////////////////////
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                             IMPLEMENTATION                              ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+
+template <typename T>
+requires std::is_arithmetic_v<T>
+inline T
+kdtree::internal::sqrt(const T n) {
+  if constexpr (std::is_floating_point_v<T>) {
+#ifdef KD__USING_SYCL
+    return sycl::sqrt(n);
+#else
+    return std::sqrt(n);
+#endif
+  } else {
+#ifdef KD__USING_SYCL
+    return static_cast<T>(sycl::sqrt(static_cast<double>(n)));
+#else
+    return static_cast<T>(std::sqrt(static_cast<double>(n)));
+#endif
+  }
+}
+
+#endif // KDTREE_INTERNAL_SQRT_HPP
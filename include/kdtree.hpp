@@ -29,6 +29,12 @@
 #include "pch.hpp"
 #include "create/create.hpp"
 #include "nn/nn.hpp"
+#include "nn/batch.hpp"
 #include "knn/knn.hpp"
+#include "knn/batch.hpp"
+#include "knn/self.hpp"
+#include "knn/graph.hpp"
+#include "radius/radius.hpp"
+#include "radius/batch.hpp"
 
 #endif // KDTREE_HPP
@@ -0,0 +1,254 @@
+/*!
+ * \file        knn/batch.hpp
+ * \author      Samridh D. Singh
+ * \date        2025-02-01
+ * \brief       batched knn header and implementation
+ * \details     answers `m` queries in parallel and writes row `i` of the
+ *              caller's m x k index and distance arrays for query `i`.
+ *
+ * \copyright   This file is part of the sycl_kdtree project.
+ * \copyright   Copyright (C) 2025, Samridh D. Singh
+ * \copyright
+ *              sycl_kdtree is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License as
+ *              published by the Free Software Foundation, either version 3 of
+ *              the License, or (at your option) any later version.
+ *
+ *              sycl_kdtree is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *              GNU General Public License for more details.
+ *
+ *              A copy of the GNU General Public License should be provided
+ *              along with sycl_kdtree.
+ *              If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef KDTREE_KNN_BATCH_HPP
+#define KDTREE_KNN_BATCH_HPP
+
+#include "../pch.hpp"
+#include "../container.hpp"
+#include <limits>
+
+namespace kdtree {
+
+// `queries` holds `m` points laid out like the tree. `idx` and `dst` are
+// flat row-major m x k arrays; row `i` receives the neighbours of query `i`
+// and their squared distances in ascending order (see ctx.euclidean). for
+// ctx.budget, see query::budget.
+template<typename F, typename T, T dim,
+         kdtree::container::layout maj = kdtree::container::layout::row_major,
+         typename C_query, typename C_tree, typename C_idx, typename C_dst>
+
+requires kdtree::container::container<C_query>
+      && kdtree::container::container<C_tree>
+      && kdtree::container::container_1d<C_idx>
+      && kdtree::container::container_1d<C_dst>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_idx>, T>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_dst>, F>
+
+void
+knn_batch(const kdtree::context& ctx,
+          const C_query&        queries,
+          const T               m,
+          const C_tree&         tree,
+          const T               n,
+          const T               k,
+          C_idx&                idx,
+          C_dst&                dst,
+          const F               rmax = std::numeric_limits<F>::max());
+
+// for trees built with an adaptive create; `dims` holds the split dimension
+// of every node.
+template<typename F, typename T, T dim,
+         kdtree::container::layout maj = kdtree::container::layout::row_major,
+         typename C_query, typename C_tree, typename C_dim, typename C_idx,
+         typename C_dst>
+
+requires kdtree::container::container<C_query>
+      && kdtree::container::container<C_tree>
+      && kdtree::container::container_1d<C_dim>
+      && kdtree::container::container_1d<C_idx>
+      && kdtree::container::container_1d<C_dst>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_idx>, T>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_dst>, F>
+
+void
+knn_batch(const kdtree::context& ctx,
+          const C_query&        queries,
+          const T               m,
+          const C_tree&         tree,
+          const T               n,
+          const C_dim&          dims,
+          const T               k,
+          C_idx&                idx,
+          C_dst&                dst,
+          const F               rmax = std::numeric_limits<F>::max());
+
+} // namespace kdtree
+
+///////////////////////////////////////////////////////////////////////////////
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                             IMPLEMENTATION                              ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "knn.hpp"
+#include "heap.hpp"
+#include "../traverse/traverse.hpp"
+
+#include <array>
+#include <cstddef>
+
+namespace kdtree   {
+namespace internal {
+namespace knn      {
+
+// the rows of knn_batch, whatever the split dimensions.
+template <typename F, typename T, T dim, kdtree::container::layout maj,
+          typename f_splitdim, typename C_query, typename C_tree,
+          typename C_idx, typename C_dst>
+void
+batch(const kdtree::context& ctx, const C_query& queries, const T m,
+      const C_tree& tree, const T n, const T k, C_idx& idx, C_dst& dst,
+      const F rmax, const f_splitdim& splitdim) {
+
+  using kdtree::container::id;
+
+  using V = kdtree::container::get_primitive_t<C_tree>;
+  using Q = std::array<V, static_cast<std::size_t>(dim)>;
+  using R = view_t<F, T, C_idx, C_dst>;
+
+  if (k <= T{0}) {
+    return;
+  }
+
+  // query costs vary with the local density, so small chunks are handed out
+  // on demand. every chunk copies its queries into the same stack buffer,
+  // which also gives traverse a contiguous point whatever the layout.
+
+  constexpr T grain{T{64}};
+
+  ctx.pool().parallel_for(T{0}, m, grain, [&](const T i0, const T i1) {
+
+    Q q;
+
+    for (T i{i0}; i < i1; ++i) {
+
+      for (T e{0}; e < dim; ++e) {
+        q[static_cast<std::size_t>(e)] = id<T, dim, maj>(queries, m, i, e);
+      }
+
+      const std::size_t o{static_cast<std::size_t>(i)
+                        * static_cast<std::size_t>(k)};
+      R res{{idx, o}, {dst, o}, k};
+      for (T j{0}; j < k; ++j) {
+        res.idx[static_cast<std::size_t>(j)] = T{0};
+        res.dst[static_cast<std::size_t>(j)] = std::numeric_limits<F>::max();
+      }
+
+      kdtree::internal::traverse::run<
+        R,
+        f_process<F, T, dim, maj, Q, C_tree>,
+        f_splitdim,
+        F, T, dim, maj,
+        Q, C_tree
+      >(ctx, res, q, tree, n, rmax, splitdim);
+
+      heapsort<T, dim, maj>(res.idx, res.dst, k);
+      kdtree::internal::knn::report<F>(ctx, res.dst, k);
+
+    }
+
+  });
+
+}
+
+} // namespace knn
+} // namespace internal
+} // namespace kdtree
+
+template<typename F, typename T, T dim, kdtree::container::layout maj,
+         typename C_query, typename C_tree, typename C_idx, typename C_dst>
+requires kdtree::container::container<C_query>
+      && kdtree::container::container<C_tree>
+      && kdtree::container::container_1d<C_idx>
+      && kdtree::container::container_1d<C_dst>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_idx>, T>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_dst>, F>
+void
+kdtree::knn_batch(const kdtree::context& ctx,
+                  const C_query&        queries,
+                  const T               m,
+                  const C_tree&         tree,
+                  const T               n,
+                  const T               k,
+                  C_idx&                idx,
+                  C_dst&                dst,
+                  const F               rmax) {
+
+  using f_splitdim = kdtree::internal::traverse::f_splitdim<
+    T, dim, maj, C_tree>;
+
+  kdtree::internal::knn::batch<F, T, dim, maj>(ctx, queries, m, tree, n, k,
+                                               idx, dst, rmax, f_splitdim{});
+
+}
+
+template<typename F, typename T, T dim, kdtree::container::layout maj,
+         typename C_query, typename C_tree, typename C_dim, typename C_idx,
+         typename C_dst>
+requires kdtree::container::container<C_query>
+      && kdtree::container::container<C_tree>
+      && kdtree::container::container_1d<C_dim>
+      && kdtree::container::container_1d<C_idx>
+      && kdtree::container::container_1d<C_dst>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_idx>, T>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_dst>, F>
+void
+kdtree::knn_batch(const kdtree::context& ctx,
+                  const C_query&        queries,
+                  const T               m,
+                  const C_tree&         tree,
+                  const T               n,
+                  const C_dim&          dims,
+                  const T               k,
+                  C_idx&                idx,
+                  C_dst&                dst,
+                  const F               rmax) {
+
+  using f_splitdim = kdtree::internal::traverse::f_splitdim_table<
+    T, dim, maj, C_tree, C_dim>;
+
+  kdtree::internal::knn::batch<F, T, dim, maj>(ctx, queries, m, tree, n, k,
+                                               idx, dst, rmax, 
+                                               f_splitdim{dims});
+
+}
+
+#endif // KDTREE_KNN_BATCH_HPP
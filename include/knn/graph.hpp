@@ -0,0 +1,263 @@
+/*!
+ * \file        knn/graph.hpp
+ * \author      Samridh D. Singh
+ * \date        2025-02-01
+ * \brief       k-nearest-neighbour graph header and implementation
+ * \details     the knn graph of the points of the tree in CSR form, built
+ *              from one self_knn pass and, when asked for, made symmetric
+ *              by adding every missing reverse edge.
+ *
+ * \copyright   This file is part of the sycl_kdtree project.
+ * \copyright   Copyright (C) 2025, Samridh D. Singh
+ * \copyright
+ *              sycl_kdtree is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License as
+ *              published by the Free Software Foundation, either version 3 of
+ *              the License, or (at your option) any later version.
+ *
+ *              sycl_kdtree is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *              GNU General Public License for more details.
+ *
+ *              A copy of the GNU General Public License should be provided
+ *              along with sycl_kdtree.
+ *              If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef KDTREE_KNN_GRAPH_HPP
+#define KDTREE_KNN_GRAPH_HPP
+
+#include "../pch.hpp"
+#include "../container.hpp"
+
+#include <vector>
+
+namespace kdtree {
+
+// CSR output: the neighbours of the point at position `i` of the tree are
+// idx[off[i] .. off[i+1]) with their squared distances (see ctx.euclidean)
+// at the same positions of `dst`, in ascending order. every row holds the
+// min(k, n - 1) nearest other points, found as by self_knn. with `symmetric`
+// a point also lists every point that has it as a neighbour, so that `j` is
+// in the row of `i` exactly when `i` is in the row of `j`; rows then differ
+// in length and never repeat a neighbour. like self_knn the graph is exact
+// whatever ctx.budget and ctx.eps say.
+template<typename F, typename T, T dim,
+         kdtree::container::layout maj = kdtree::container::layout::row_major,
+         typename C_tree>
+requires kdtree::container::container<C_tree>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+void
+knn_graph(const kdtree::context& ctx, const C_tree& tree, const T n,
+          const T k, std::vector<T>& off, std::vector<T>& idx,
+          std::vector<F>& dst, const bool symmetric = false);
+
+// for trees built with an adaptive create; `dims` holds the split dimension
+// of every node, see self_knn.
+template<typename F, typename T, T dim,
+         kdtree::container::layout maj = kdtree::container::layout::row_major,
+         typename C_tree, typename C_dim>
+requires kdtree::container::container<C_tree>
+      && kdtree::container::container_1d<C_dim>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+void
+knn_graph(const kdtree::context& ctx, const C_tree& tree, const T n,
+          const C_dim& dims, const T k, std::vector<T>& off, 
+          std::vector<T>& idx, std::vector<F>& dst, 
+          const bool symmetric = false);
+
+} // namespace kdtree
+
+///////////////////////////////////////////////////////////////////////////////
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                             IMPLEMENTATION                              ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "self.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace kdtree   {
+namespace internal {
+namespace graph    {
+
+// knn_graph for any tree: `rows(w, idx, dst)` fills the n x w rows of
+// self_knn.
+template <typename F, typename T, typename f_rows>
+void
+build(const kdtree::context& ctx, const T n, const T k, std::vector<T>& off,
+      std::vector<T>& idx, std::vector<F>& dst, const bool symmetric,
+      f_rows rows) {
+
+  constexpr T grain{T{64}};
+
+  const T           w { k > T{0} && n > T{0} ? std::min(k, n - T{1}) : T{0} };
+  const std::size_t W { static_cast<std::size_t>(w)                         };
+
+  // the rows of the plain graph all have `w` entries: self_knn writes them
+  // in place, each query keeping its heap in its own row.
+
+  const auto dense = [&](std::vector<T>& idx_, std::vector<F>& dst_) {
+    idx_.resize(static_cast<std::size_t>(n) * W);
+    dst_.resize(static_cast<std::size_t>(n) * W);
+    rows(w, idx_, dst_);
+  };
+
+  if (!symmetric) {
+    off.resize(static_cast<std::size_t>(n) + 1);
+    for (std::size_t i{0}; i < off.size(); ++i) {
+      off[i] = static_cast<T>(i * W);
+    }
+    dense(idx, dst);
+    return;
+  }
+
+  std::vector<T> a_idx;
+  std::vector<F> a_dst;
+  dense(a_idx, a_dst);
+
+  // miss[i * W + j] marks the edge from `i` to its j-th neighbour when `i`
+  // is not among that neighbour's own; those edges are added reversed.
+
+  std::vector<std::uint8_t> miss(static_cast<std::size_t>(n) * W);
+
+  ctx.pool().parallel_for(T{0}, n, grain, [&](const T i0, const T i1) {
+    for (T i{i0}; i < i1; ++i) {
+      const std::size_t o{static_cast<std::size_t>(i) * W};
+      for (std::size_t j{0}; j < W; ++j) {
+        const auto b{a_idx.begin() + static_cast<std::ptrdiff_t>(
+                       static_cast<std::size_t>(a_idx[o + j]) * W)};
+        miss[o + j] = std::find(b, b + static_cast<std::ptrdiff_t>(W), i)
+                   == b + static_cast<std::ptrdiff_t>(W);
+      }
+    }
+  });
+
+  // off[i + 1] counts the row of `i`, then a prefix sum turns the counts
+  // into offsets.
+
+  off.assign(static_cast<std::size_t>(n) + 1, w);
+  off[0] = T{0};
+  for (std::size_t e{0}; e < miss.size(); ++e) {
+    if (miss[e]) ++off[static_cast<std::size_t>(a_idx[e]) + 1];
+  }
+  for (std::size_t i{1}; i < off.size(); ++i) off[i] += off[i - 1];
+
+  idx.resize(static_cast<std::size_t>(off.back()));
+  dst.resize(static_cast<std::size_t>(off.back()));
+
+  // every row starts with its own neighbours and gets the reverse edges
+  // appended behind them, in the order of their sources.
+
+  std::vector<T> end(off.begin(), off.end() - 1);
+  for (std::size_t i{0}; i < static_cast<std::size_t>(n); ++i) {
+    end[i] += w;
+  }
+  for (std::size_t e{0}; e < miss.size(); ++e) {
+    if (miss[e]) {
+      const std::size_t r{static_cast<std::size_t>(a_idx[e])};
+      const std::size_t p{static_cast<std::size_t>(end[r]++)};
+      idx[p] = static_cast<T>(e / W);
+      dst[p] = a_dst[e];
+    }
+  }
+
+  // a row's own neighbours come sorted by distance, but its reverse edges
+  // were appended in the order of their sources: those are sorted first,
+  // then the two parts are merged, ties keeping the order of their
+  // positions.
+
+  ctx.pool().parallel_for(T{0}, n, grain, [&](const T i0, const T i1) {
+
+    std::vector<std::pair<F, T>> row;
+
+    for (T i{i0}; i < i1; ++i) {
+
+      const std::size_t r{static_cast<std::size_t>(i)};
+      const std::size_t b{static_cast<std::size_t>(off[r])};
+      const std::size_t e{static_cast<std::size_t>(off[r + 1])};
+
+      row.clear();
+      for (std::size_t j{0}; j < W; ++j) {
+        row.emplace_back(a_dst[r * W + j], a_idx[r * W + j]);
+      }
+      for (std::size_t p{b + W}; p < e; ++p) {
+        row.emplace_back(dst[p], idx[p]);
+      }
+
+      const auto mid{row.begin() + static_cast<std::ptrdiff_t>(W)};
+      std::stable_sort(mid, row.end(), [](const auto& l, const auto& r_) {
+        return l.first < r_.first;
+      });
+      std::inplace_merge(row.begin(), mid, row.end(),
+                         [](const auto& l, const auto& r_) {
+                           return l.first < r_.first;
+                         });
+
+      for (std::size_t p{0}; p < row.size(); ++p) {
+        dst[b + p] = row[p].first;
+        idx[b + p] = row[p].second;
+      }
+
+    }
+
+  });
+
+}
+
+} // namespace graph
+} // namespace internal
+} // namespace kdtree
+
+template<typename F, typename T, T dim, kdtree::container::layout maj,
+         typename C_tree>
+requires kdtree::container::container<C_tree>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+void
+kdtree::knn_graph(const kdtree::context& ctx, const C_tree& tree, const T n,
+                  const T k, std::vector<T>& off, std::vector<T>& idx,
+                  std::vector<F>& dst, const bool symmetric) {
+
+  kdtree::internal::graph::build(ctx, n, k, off, idx, dst, symmetric,
+    [&](const T w, std::vector<T>& idx_, std::vector<F>& dst_) {
+      kdtree::self_knn<F, T, dim, maj>(ctx, tree, n, w, idx_, dst_);
+    });
+
+}
+
+template<typename F, typename T, T dim, kdtree::container::layout maj,
+         typename C_tree, typename C_dim>
+requires kdtree::container::container<C_tree>
+      && kdtree::container::container_1d<C_dim>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+void
+kdtree::knn_graph(const kdtree::context& ctx, const C_tree& tree,
+                  const T n, const C_dim& dims, const T k,
+                  std::vector<T>& off, std::vector<T>& idx,
+                  std::vector<F>& dst, const bool symmetric) {
+
+  kdtree::internal::graph::build(ctx, n, k, off, idx, dst, symmetric,
+    [&](const T w, std::vector<T>& idx_, std::vector<F>& dst_) {
+      kdtree::self_knn<F, T, dim, maj>(ctx, tree, n, dims, w, idx_, dst_);
+    });
+
+}
+
+#endif // KDTREE_KNN_GRAPH_HPP
@@ -57,6 +57,20 @@ requires std::is_integral_v<T>
 constexpr void
 heapsort(C_idx& idx, C_dst& dst, const T k);
 
+// inserts `(i, d)` into the first `k` entries of `idx` and `dst`, which are
+// kept in ascending order of `dst`; the last entry drops out.
+template <typename T, typename C_idx, typename C_dst>
+
+requires std::is_integral_v<T>
+      && kdtree::container::container_1d<C_idx>
+      && kdtree::container::container_1d<C_dst>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_idx>, T>
+      && std::is_arithmetic_v<kdtree::container::get_primitive_t<C_dst>>
+
+constexpr void
+insert(C_idx& idx, C_dst& dst, const T k, const T i,
+       const kdtree::container::get_primitive_t<C_dst> d);
+
 } // namespace kdtree
 } // namespace internal
 } // namespace knn
@@ -125,4 +139,27 @@ kdtree::internal::knn::heapsort(C_idx& idx, C_dst& dst, const T k) {
   }
 }
 
+template <typename T, typename C_idx, typename C_dst>
+requires std::is_integral_v<T>
+      && kdtree::container::container_1d<C_idx>
+      && kdtree::container::container_1d<C_dst>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_idx>, T>
+      && std::is_arithmetic_v<kdtree::container::get_primitive_t<C_dst>>
+
+constexpr void
+kdtree::internal::knn::insert(C_idx& idx, C_dst& dst, const T k, const T i,
+                              const kdtree::container::get_primitive_t<C_dst> d)
+{
+  using kdtree::container::id;
+
+  T j{k - 1};
+  for (; j > 0 && id<T>(dst, k, j - 1) > d; --j) {
+    id<T>(dst, k, j) = id<T>(dst, k, j - 1);
+    id<T>(idx, k, j) = id<T>(idx, k, j - 1);
+  }
+  id<T>(dst, k, j) = d;
+  id<T>(idx, k, j) = i;
+
+}
+
 #endif // KDTREE_KNN_HEAP_HPP
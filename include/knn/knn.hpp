@@ -28,11 +28,15 @@
 
 #include "../pch.hpp"
 #include "../container.hpp"
+#include <array>
+#include <cstddef>
 #include <limits>
 #include <vector>
 
 namespace kdtree {
 
+// with ctx.eps > 0 the j-th neighbour returned is at most (1 + eps) times
+// farther than the true j-th nearest point.
 template<typename F, typename T, T dim,
          kdtree::container::layout maj = kdtree::container::layout::row_major,
          typename C_query, typename C_tree> 
@@ -45,13 +49,122 @@ requires kdtree::container::container_1d<C_query>
                         kdtree::container::get_primitive_t<C_tree>>
 
 constexpr std::vector<T>
-knn(const kdtree::context& ctx,
+knn(const kdtree::query&   ctx,
     const C_query&        q,
     const C_tree&         tree,
     const T               n,
     const T               k,
     const F               rmax = std::numeric_limits<F>::max());
 
+// for trees built with an adaptive create; `dims` holds the split dimension
+// of every node.
+template<typename F, typename T, T dim,
+         kdtree::container::layout maj = kdtree::container::layout::row_major,
+         typename C_query, typename C_tree, typename C_dim> 
+
+requires kdtree::container::container_1d<C_query> 
+      && kdtree::container::container<C_tree>
+      && kdtree::container::container_1d<C_dim>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+
+constexpr std::vector<T>
+knn(const kdtree::query&   ctx,
+    const C_query&        q,
+    const C_tree&         tree,
+    const T               n,
+    const C_dim&          dims,
+    const T               k,
+    const F               rmax = std::numeric_limits<F>::max());
+
+// fills `idx[j]` and `dst[j]`, j < k, with the neighbours of `q` and their
+// squared distances in ascending order; ctx.euclidean reports the distances
+// themselves. returns false when ctx.budget ran out first: the rows then
+// hold the best candidates found, still sorted.
+template<typename F, typename T, T dim,
+         kdtree::container::layout maj = kdtree::container::layout::row_major,
+         typename C_query, typename C_tree, typename C_idx, typename C_dst> 
+
+requires kdtree::container::container_1d<C_query> 
+      && kdtree::container::container<C_tree>
+      && kdtree::container::container_1d<C_idx>
+      && kdtree::container::container_1d<C_dst>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_idx>, T>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_dst>, F>
+
+constexpr bool
+knn(const kdtree::query&   ctx,
+    const C_query&        q,
+    const C_tree&         tree,
+    const T               n,
+    const T               k,
+    C_idx&                idx,
+    C_dst&                dst,
+    const F               rmax = std::numeric_limits<F>::max());
+
+// warm start: the first `s` indices of `seed`, such as the neighbours found
+// for the same point a step earlier, are measured before the walk, so it
+// starts from the k-th of their distances as its bound. `seed` may be `idx`
+// itself; indices outside the tree and repeats are ignored. otherwise as
+// above.
+template<typename F, typename T, T dim,
+         kdtree::container::layout maj = kdtree::container::layout::row_major,
+         typename C_query, typename C_tree, typename C_seed, typename C_idx,
+         typename C_dst>
+
+requires kdtree::container::container_1d<C_query> 
+      && kdtree::container::container<C_tree>
+      && kdtree::container::container_1d<C_seed>
+      && kdtree::container::container_1d<C_idx>
+      && kdtree::container::container_1d<C_dst>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_seed>, T>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_idx>, T>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_dst>, F>
+
+constexpr bool
+knn(const kdtree::query&   ctx,
+    const C_query&        q,
+    const C_tree&         tree,
+    const T               n,
+    const T               k,
+    const C_seed&         seed,
+    const T               s,
+    C_idx&                idx,
+    C_dst&                dst,
+    const F               rmax = std::numeric_limits<F>::max());
+
+// `K` fixed at compile time: the candidates live in std::arrays, so the query
+// never allocates and can be called from a SYCL kernel like nn. up to 16
+// candidates are kept sorted by insertion, more go through the heap.
+template<std::size_t K, typename F, typename T, T dim,
+         kdtree::container::layout maj = kdtree::container::layout::row_major,
+         typename C_query, typename C_tree> 
+
+requires kdtree::container::container_1d<C_query> 
+      && kdtree::container::container<C_tree>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+      && (K > 0)
+
+constexpr std::array<T, K>
+knn(const kdtree::query&   ctx,
+    const C_query&        q,
+    const C_tree&         tree,
+    const T               n,
+    const F               rmax = std::numeric_limits<F>::max());
+
 } // namespace kdtree
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -70,6 +183,7 @@ knn(const kdtree::context& ctx,
 
 #include "../traverse/traverse.hpp"
 #include "../internal/dist.hpp"
+#include "../internal/sqrt.hpp"
 
 #include "heap.hpp"
 
@@ -94,11 +208,50 @@ struct result_t {
   {}
 };
 
+// row `o / k` of a flat output array, seen as a container of its own.
+template <typename C>
+requires kdtree::container::container_1d<C>
+struct row_t {
+
+  C&          v;
+  std::size_t o;
+
+  constexpr auto&
+  operator[](const std::size_t i) const { return v[o + i]; }
+
+};
+
+// a result kept in the caller's output rows: the heap is built in place, so
+// the query allocates nothing and its result needs no copy once sorted.
+template <typename F, typename T, typename C_idx, typename C_dst>
+requires std::is_arithmetic_v<F> && std::is_integral_v<T>
+struct view_t {
+  row_t<C_idx> idx;
+  row_t<C_dst> dst;
+  const T      k;
+};
+
+// turns the first `k` squared distances of `dst` into distances when the
+// context asks for them; empty slots keep their sentinel.
+template <typename F, typename T, typename C_dst>
+requires std::is_arithmetic_v<F> && std::is_integral_v<T>
+constexpr void
+report(const kdtree::query& ctx, C_dst& dst, const T k) {
+  if (!ctx.euclidean) return;
+  for (T j{0}; j < k; ++j) {
+    F& d{dst[static_cast<std::size_t>(j)]};
+    if (d < std::numeric_limits<F>::max()) d = kdtree::internal::sqrt(d);
+  }
+}
+
+// `res` is any result with `idx`, `dst` and `k` members, such as view_t.
+
 template <typename F, typename T, T dim, kdtree::container::layout maj,
           typename C_query, typename C_tree>
 struct f_process {
+  template <typename result_t>
   void operator()(
-      result_t<F, T>&   res,
+      result_t&         res,
       const C_query&    q,
       const C_tree&     src,
       const T           n,
@@ -115,16 +268,169 @@ struct f_process {
       res.dst[0] = dst;
       res.idx[0] = idx;
 
-      if (dst < *rmax) {
-        *rmax = dst;
+      maxheapify<T, dim, maj>(res.idx, res.dst, res.k);
+
+      // nothing farther than the k-th candidate can enter the heap.
+      if (res.dst[0] < *rmax) {
+        *rmax = res.dst[0];
+      }
+
+    }
+  }
+};
+
+template <typename F, typename T, std::size_t K>
+requires
+    std::is_arithmetic_v<F> &&
+    std::is_integral_v<T>
+struct result_k_t {
+
+  std::array<T, K> idx;
+  std::array<F, K> dst;
+  const T          k{static_cast<T>(K)};
+
+  constexpr result_k_t() {
+    for (std::size_t i{0}; i < K; ++i) {
+      idx[i] = T{0};
+      dst[i] = std::numeric_limits<F>::max();
+    }
+  }
+};
+
+// f_process for candidates kept in ascending order; the worst is last.
+
+template <typename F, typename T, T dim, kdtree::container::layout maj,
+          typename C_query, typename C_tree>
+struct f_insert {
+  template <typename result_t>
+  void operator()(
+      result_t&         res,
+      const C_query&    q,
+      const C_tree&     src,
+      const T           n,
+      const T           idx,
+      F*                rmax
+  ) const {
+    using kdtree::internal::dist::euclidian;
+
+    const F dst {
+      euclidian<F, T, dim, maj, C_query, maj, C_tree>(q, 1, 0, src, n, idx)
+    };
+
+    if (dst < res.dst[static_cast<std::size_t>(res.k - 1)]) {
+      insert(res.idx, res.dst, res.k, idx, dst);
+
+      const F last{res.dst[static_cast<std::size_t>(res.k - 1)]};
+      if (last < *rmax) {
+        *rmax = last;
+      }
+    }
+  }
+};
+
+// f_process for a heap filled by warm: the walk meets the seeded points
+// again, and they must not enter twice.
+
+template <typename F, typename T, T dim, kdtree::container::layout maj,
+          typename C_query, typename C_tree>
+struct f_warm {
+  template <typename result_t>
+  void operator()(
+      result_t&         res,
+      const C_query&    q,
+      const C_tree&     src,
+      const T           n,
+      const T           idx,
+      F*                rmax
+  ) const {
+    using kdtree::internal::dist::euclidian;
+
+    const F dst {
+      euclidian<F, T, dim, maj, C_query, maj, C_tree>(q, 1, 0, src, n, idx)
+    };
+
+    if (dst < res.dst[0]) {
+      for (T j{0}; j < res.k; ++j) {
+        const std::size_t j_{static_cast<std::size_t>(j)};
+        if (res.idx[j_] == idx && res.dst[j_] == dst) return;
       }
 
+      res.dst[0] = dst;
+      res.idx[0] = idx;
+
       maxheapify<T, dim, maj>(res.idx, res.dst, res.k);
 
+      if (res.dst[0] < *rmax) {
+        *rmax = res.dst[0];
+      }
     }
   }
 };
 
+// builds the heap of `res` from the first `s` indices of `seed`. the slots
+// are written in the order the seeds are read, so `seed` may be `res.idx`.
+
+template <typename F, typename T, T dim, kdtree::container::layout maj,
+          typename C_query, typename C_tree, typename C_seed,
+          typename result_t>
+constexpr void
+warm(result_t& res, const C_query& q, const C_tree& src, const T n,
+     const C_seed& seed, const T s) {
+
+  using kdtree::internal::dist::euclidian;
+
+  constexpr F none{std::numeric_limits<F>::max()};
+
+  const auto in_tree = [n](const T i) {
+    if constexpr (std::is_signed_v<T>) {
+      if (i < T{0}) return false;
+    }
+    return i < n;
+  };
+
+  const auto seeded = [&res, none](const T i, const T m) {
+    for (T j{0}; j < m; ++j) {
+      const std::size_t j_{static_cast<std::size_t>(j)};
+      if (res.idx[j_] == i && res.dst[j_] < none) return true;
+    }
+    return false;
+  };
+
+  const T m{s < res.k ? s : res.k};
+
+  for (T j{0}; j < res.k; ++j) {
+    const std::size_t j_{static_cast<std::size_t>(j)};
+    const T c{j < m ? static_cast<T>(seed[j_]) : n};
+    if (in_tree(c) && !seeded(c, j)) {
+      res.idx[j_] = c;
+      res.dst[j_] =
+        euclidian<F, T, dim, maj, C_query, maj, C_tree>(q, 1, 0, src, n, c);
+    } else {
+      res.idx[j_] = T{0};
+      res.dst[j_] = none;
+    }
+  }
+
+  for (T i{res.k / 2}; i > 0; ) {
+    --i;
+    maxheapify<T, dim, maj>(res.idx, res.dst, res.k, i);
+  }
+
+  for (T j{m}; j < s; ++j) {
+    const T c{static_cast<T>(seed[static_cast<std::size_t>(j)])};
+    if (!in_tree(c) || seeded(c, res.k)) continue;
+    const F d{
+      euclidian<F, T, dim, maj, C_query, maj, C_tree>(q, 1, 0, src, n, c)
+    };
+    if (d < res.dst[0]) {
+      res.dst[0] = d;
+      res.idx[0] = c;
+      maxheapify<T, dim, maj>(res.idx, res.dst, res.k);
+    }
+  }
+
+}
+
 } // namespace knn
 } // namespace internal
 } // namespace kdtree
@@ -140,7 +446,7 @@ requires
     std::is_same_v<kdtree::container::get_primitive_t<C_query>,
                    kdtree::container::get_primitive_t<C_tree>>
 constexpr std::vector<T>
-kdtree::knn(const kdtree::context& ctx,
+kdtree::knn(const kdtree::query&   ctx,
             const C_query&        q,
             const C_tree&         tree,
             const T               n,
@@ -151,19 +457,212 @@ kdtree::knn(const kdtree::context& ctx,
   using kdtree::internal::knn::f_process;
   using kdtree::internal::knn::result_t;
 
-  (void) ctx;
+  result_t<F, T> result(k);
+
+  kdtree::internal::traverse::run<
+    result_t<F, T>,
+    f_process<F, T, dim, maj, C_query, C_tree>,
+    f_splitdim<T, dim, maj, C_tree>,
+    F, T, dim, maj,
+    C_query, C_tree
+  >(ctx, result, q, tree, n, rmax);
+
+  kdtree::internal::knn::heapsort<T, dim, maj>(result.idx, result.dst, k);
+
+  return result.idx;
+}
+
+template<typename F, typename T, T dim, kdtree::container::layout maj,
+         typename C_query, typename C_tree, typename C_dim> 
+requires
+    kdtree::container::container_1d<C_query> &&
+    kdtree::container::container<C_tree> &&
+    kdtree::container::container_1d<C_dim> &&
+    std::is_integral_v<T> &&
+    std::is_arithmetic_v<F> &&
+    std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                   kdtree::container::get_primitive_t<C_tree>>
+constexpr std::vector<T>
+kdtree::knn(const kdtree::query&   ctx,
+            const C_query&        q,
+            const C_tree&         tree,
+            const T               n,
+            const C_dim&          dims,
+            const T               k,
+            const F               rmax) {
+
+  using kdtree::internal::traverse::f_splitdim_table;
+  using kdtree::internal::knn::f_process;
+  using kdtree::internal::knn::result_t;
 
   result_t<F, T> result(k);
 
-  kdtree::traverse<
+  using f_splitdim = f_splitdim_table<T, dim, maj, C_tree, C_dim>;
+
+  kdtree::internal::traverse::run<
     result_t<F, T>,
     f_process<F, T, dim, maj, C_query, C_tree>,
+    f_splitdim,
+    F, T, dim, maj,
+    C_query, C_tree
+  >(ctx, result, q, tree, n, rmax, f_splitdim{dims});
+
+  kdtree::internal::knn::heapsort<T, dim, maj>(result.idx, result.dst, k);
+
+  return result.idx;
+}
+
+template<typename F, typename T, T dim, kdtree::container::layout maj,
+         typename C_query, typename C_tree, typename C_idx, typename C_dst> 
+requires
+    kdtree::container::container_1d<C_query> &&
+    kdtree::container::container<C_tree> &&
+    kdtree::container::container_1d<C_idx> &&
+    kdtree::container::container_1d<C_dst> &&
+    std::is_integral_v<T> &&
+    std::is_arithmetic_v<F> &&
+    std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                   kdtree::container::get_primitive_t<C_tree>> &&
+    std::is_same_v<kdtree::container::get_primitive_t<C_idx>, T> &&
+    std::is_same_v<kdtree::container::get_primitive_t<C_dst>, F>
+constexpr bool
+kdtree::knn(const kdtree::query&   ctx,
+            const C_query&        q,
+            const C_tree&         tree,
+            const T               n,
+            const T               k,
+            C_idx&                idx,
+            C_dst&                dst,
+            const F               rmax) {
+
+  using kdtree::internal::traverse::f_splitdim;
+  using kdtree::internal::knn::f_process;
+  using kdtree::internal::knn::view_t;
+
+  using R = view_t<F, T, C_idx, C_dst>;
+
+  if (k <= T{0}) {
+    return true;
+  }
+
+  R result{{idx, 0}, {dst, 0}, k};
+  for (T j{0}; j < k; ++j) {
+    result.idx[static_cast<std::size_t>(j)] = T{0};
+    result.dst[static_cast<std::size_t>(j)] = std::numeric_limits<F>::max();
+  }
+
+  const bool exact = kdtree::internal::traverse::run<
+    R,
+    f_process<F, T, dim, maj, C_query, C_tree>,
     f_splitdim<T, dim, maj, C_tree>,
     F, T, dim, maj,
     C_query, C_tree
-  >(result, q, tree, n, rmax);
+  >(ctx, result, q, tree, n, rmax);
 
   kdtree::internal::knn::heapsort<T, dim, maj>(result.idx, result.dst, k);
+  kdtree::internal::knn::report<F>(ctx, result.dst, k);
+
+  return exact;
+
+}
+
+template<typename F, typename T, T dim, kdtree::container::layout maj,
+         typename C_query, typename C_tree, typename C_seed, typename C_idx,
+         typename C_dst> 
+requires
+    kdtree::container::container_1d<C_query> &&
+    kdtree::container::container<C_tree> &&
+    kdtree::container::container_1d<C_seed> &&
+    kdtree::container::container_1d<C_idx> &&
+    kdtree::container::container_1d<C_dst> &&
+    std::is_integral_v<T> &&
+    std::is_arithmetic_v<F> &&
+    std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                   kdtree::container::get_primitive_t<C_tree>> &&
+    std::is_same_v<kdtree::container::get_primitive_t<C_seed>, T> &&
+    std::is_same_v<kdtree::container::get_primitive_t<C_idx>, T> &&
+    std::is_same_v<kdtree::container::get_primitive_t<C_dst>, F>
+constexpr bool
+kdtree::knn(const kdtree::query&   ctx,
+            const C_query&        q,
+            const C_tree&         tree,
+            const T               n,
+            const T               k,
+            const C_seed&         seed,
+            const T               s,
+            C_idx&                idx,
+            C_dst&                dst,
+            const F               rmax) {
+
+  using kdtree::internal::traverse::f_splitdim;
+  using kdtree::internal::knn::f_warm;
+  using kdtree::internal::knn::view_t;
+
+  using R = view_t<F, T, C_idx, C_dst>;
+
+  if (k <= T{0}) {
+    return true;
+  }
+
+  R result{{idx, 0}, {dst, 0}, k};
+  kdtree::internal::knn::warm<F, T, dim, maj, C_query, C_tree>(
+    result, q, tree, n, seed, s);
+
+  const F bound{result.dst[0] < rmax ? result.dst[0] : rmax};
+
+  const bool exact = kdtree::internal::traverse::run<
+    R,
+    f_warm<F, T, dim, maj, C_query, C_tree>,
+    f_splitdim<T, dim, maj, C_tree>,
+    F, T, dim, maj,
+    C_query, C_tree
+  >(ctx, result, q, tree, n, bound);
+
+  kdtree::internal::knn::heapsort<T, dim, maj>(result.idx, result.dst, k);
+  kdtree::internal::knn::report<F>(ctx, result.dst, k);
+
+  return exact;
+
+}
+
+template<std::size_t K, typename F, typename T, T dim,
+         kdtree::container::layout maj, typename C_query, typename C_tree> 
+requires
+    kdtree::container::container_1d<C_query> &&
+    kdtree::container::container<C_tree> &&
+    std::is_integral_v<T> &&
+    std::is_arithmetic_v<F> &&
+    std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                   kdtree::container::get_primitive_t<C_tree>> &&
+    (K > 0)
+constexpr std::array<T, K>
+kdtree::knn(const kdtree::query&   ctx,
+            const C_query&        q,
+            const C_tree&         tree,
+            const T               n,
+            const F               rmax) {
+
+  using kdtree::internal::traverse::f_splitdim;
+  using kdtree::internal::knn::result_k_t;
+
+  using f_process = std::conditional_t<(K <= 16),
+    kdtree::internal::knn::f_insert <F, T, dim, maj, C_query, C_tree>,
+    kdtree::internal::knn::f_process<F, T, dim, maj, C_query, C_tree>>;
+
+  result_k_t<F, T, K> result;
+
+  kdtree::internal::traverse::run<
+    result_k_t<F, T, K>,
+    f_process,
+    f_splitdim<T, dim, maj, C_tree>,
+    F, T, dim, maj,
+    C_query, C_tree
+  >(ctx, result, q, tree, n, rmax);
+
+  if constexpr (K > 16) {
+    kdtree::internal::knn::heapsort<T, dim, maj>(result.idx, result.dst,
+                                                 result.k);
+  }
 
   return result.idx;
 }
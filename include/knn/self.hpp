@@ -0,0 +1,434 @@
+/*!
+ * \file        knn/self.hpp
+ * \author      Samridh D. Singh
+ * \date        2025-02-01
+ * \brief       all-points knn header and implementation
+ * \details     neighbours of the points of the tree itself. every query
+ *              starts at the node that holds its point, collects candidates
+ *              from that node's subtree and climbs towards the root, trying
+ *              the sibling subtree at every level.
+ *
+ * \copyright   This file is part of the sycl_kdtree project.
+ * \copyright   Copyright (C) 2025, Samridh D. Singh
+ * \copyright
+ *              sycl_kdtree is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License as
+ *              published by the Free Software Foundation, either version 3 of
+ *              the License, or (at your option) any later version.
+ *
+ *              sycl_kdtree is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *              GNU General Public License for more details.
+ *
+ *              A copy of the GNU General Public License should be provided
+ *              along with sycl_kdtree.
+ *              If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef KDTREE_KNN_SELF_HPP
+#define KDTREE_KNN_SELF_HPP
+
+#include "../pch.hpp"
+#include "../container.hpp"
+
+#include <array>
+#include <cstddef>
+
+namespace kdtree {
+
+// the `k` nearest neighbours of every point of the tree. a point is left out
+// of its own row by index, not by distance, so coincident points find each
+// other. `idx` and `dst` are flat row-major n x k arrays; row `i` belongs to
+// the point at position `i` of the tree and holds squared distances in
+// ascending order (see ctx.euclidean). the walk always runs to completion
+// and is exact: ctx.budget, ctx.eps, ctx.cell and ctx.walk are ignored.
+template<typename F, typename T, T dim,
+         kdtree::container::layout maj = kdtree::container::layout::row_major,
+         typename C_tree, typename C_idx, typename C_dst>
+
+requires kdtree::container::container<C_tree>
+      && kdtree::container::container_1d<C_idx>
+      && kdtree::container::container_1d<C_dst>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_idx>, T>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_dst>, F>
+
+void
+self_knn(const kdtree::context& ctx,
+         const C_tree&         tree,
+         const T               n,
+         const T               k,
+         C_idx&                idx,
+         C_dst&                dst);
+
+// the neighbours of the point at position `i` alone, `K` fixed at compile
+// time like knn<K>, so that each work item of a kernel can take one point.
+// exact as well.
+template<std::size_t K, typename F, typename T, T dim,
+         kdtree::container::layout maj = kdtree::container::layout::row_major,
+         typename C_tree>
+
+requires kdtree::container::container<C_tree>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && (K > 0)
+
+constexpr std::array<T, K>
+self_knn(const kdtree::query&   ctx,
+         const C_tree&         tree,
+         const T               n,
+         const T               i);
+
+// both of the above for trees built with an adaptive create; `dims` holds
+// the split dimension of every node. the walk climbs through the split
+// planes of the tree, so an adaptive tree needs these overloads.
+template<typename F, typename T, T dim,
+         kdtree::container::layout maj = kdtree::container::layout::row_major,
+         typename C_tree, typename C_dim, typename C_idx, typename C_dst>
+
+requires kdtree::container::container<C_tree>
+      && kdtree::container::container_1d<C_dim>
+      && kdtree::container::container_1d<C_idx>
+      && kdtree::container::container_1d<C_dst>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_idx>, T>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_dst>, F>
+
+void
+self_knn(const kdtree::context& ctx,
+         const C_tree&         tree,
+         const T               n,
+         const C_dim&          dims,
+         const T               k,
+         C_idx&                idx,
+         C_dst&                dst);
+
+template<std::size_t K, typename F, typename T, T dim,
+         kdtree::container::layout maj = kdtree::container::layout::row_major,
+         typename C_tree, typename C_dim>
+
+requires kdtree::container::container<C_tree>
+      && kdtree::container::container_1d<C_dim>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && (K > 0)
+
+constexpr std::array<T, K>
+self_knn(const kdtree::query&   ctx,
+         const C_tree&         tree,
+         const T               n,
+         const C_dim&          dims,
+         const T               i);
+
+} // namespace kdtree
+
+///////////////////////////////////////////////////////////////////////////////
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                             IMPLEMENTATION                              ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "knn.hpp"
+#include "heap.hpp"
+#include "../traverse/traverse.hpp"
+
+#include <limits>
+#include <type_traits>
+
+namespace kdtree   {
+namespace internal {
+namespace self     {
+
+// any knn result, plus the position of the point being queried.
+template <typename R, typename T>
+requires std::is_integral_v<T>
+struct self_t : R {
+  T self;
+};
+
+template <typename F, typename T, T dim, kdtree::container::layout maj,
+          typename C_query, typename C_tree, typename f_inner>
+struct f_process {
+  template <typename result_t>
+  void operator()(
+      result_t&         res,
+      const C_query&    q,
+      const C_tree&     src,
+      const T           n,
+      const T           idx,
+      F*                rmax
+  ) const {
+    if (idx != res.self) {
+      f_inner{}(res, q, src, n, idx, rmax);
+    }
+  }
+};
+
+// the subtree of node `res.self` comes first; each step up then visits the
+// parent and the subtree on the other side of it, when the parent's
+// splitting plane is within the bound. the point lies in the cell of every
+// node on its path, so the plane distance bounds the whole sibling subtree.
+template <typename result_t, typename f_process, typename f_splitdim,
+          typename F, typename T, T dim, kdtree::container::layout maj,
+          typename C_query, typename C_tree>
+constexpr void
+walk(result_t& res, const C_query& q, const C_tree& tree, const T n,
+     f_splitdim splitdim) {
+
+  using kdtree::container::id;
+
+  // the subtrees are walked like run would walk the whole tree.
+
+  const auto subtree = [&](F& rmax, f_splitdim& splitdim,
+                           std::size_t& visits, const T root) {
+#ifdef KD__STACKLESS
+    kdtree::internal::traverse::subtree<
+      result_t, f_process, f_splitdim, F, T, dim, maj, C_query, C_tree, false
+    >(res, q, tree, n, rmax, splitdim, 0.0f, 0, visits, root);
+#else
+    kdtree::internal::traverse::subtree_stack<
+      result_t, f_process, f_splitdim, F, T, dim, maj, C_query, C_tree
+    >(res, q, tree, n, rmax, splitdim, 0.0f, 0, visits, root);
+#endif
+  };
+
+  F           rmax   { std::numeric_limits<F>::max() };
+  std::size_t visits { 0 };
+
+  subtree(rmax, splitdim, visits, res.self);
+
+  for (T c{res.self}; c > T{0}; ) {
+
+    const T a{(c - T{1}) / T{2}};
+
+    const auto s_dim     { splitdim(tree, a)                             };
+    const auto s_pos     { id<T, dim, maj>(tree, n,   a,    s_dim)       };
+    const auto q_pos     { id<T, dim, maj>(q,   T{1}, T{0}, s_dim)       };
+    const F    sign_dist { static_cast<F>(q_pos) - static_cast<F>(s_pos) };
+    const T    sibling   { (c % T{2} == T{1}) ? c + T{1} : c - T{1}      };
+
+    // the parent's own point lies on its plane, so it is bounded as well.
+    if (sign_dist * sign_dist <= rmax) {
+      f_process{}(res, q, tree, n, a, &rmax);
+      if (sibling < n) {
+        subtree(rmax, splitdim, visits, sibling);
+      }
+    }
+
+    c = a;
+
+  }
+
+}
+
+// the rows of self_knn, whatever the split dimensions.
+template <typename F, typename T, T dim, kdtree::container::layout maj,
+          typename f_splitdim, typename C_tree, typename C_idx,
+          typename C_dst>
+void
+rows(const kdtree::context& ctx, const C_tree& tree, const T n, const T k,
+     C_idx& idx, C_dst& dst, const f_splitdim& splitdim) {
+
+  using kdtree::container::id;
+  using kdtree::internal::knn::heapsort;
+  using kdtree::internal::knn::view_t;
+
+  using V = kdtree::container::get_primitive_t<C_tree>;
+  using Q = std::array<V, static_cast<std::size_t>(dim)>;
+  using R = self_t<view_t<F, T, C_idx, C_dst>, T>;
+
+  using f_self = f_process<
+    F, T, dim, maj, Q, C_tree,
+    kdtree::internal::knn::f_process<F, T, dim, maj, Q, C_tree>>;
+
+  if (k <= T{0}) {
+    return;
+  }
+
+  // see knn_batch.
+
+  constexpr T grain{T{64}};
+
+  ctx.pool().parallel_for(T{0}, n, grain, [&](const T i0, const T i1) {
+
+    Q q;
+
+    for (T i{i0}; i < i1; ++i) {
+
+      for (T e{0}; e < dim; ++e) {
+        q[static_cast<std::size_t>(e)] = id<T, dim, maj>(tree, n, i, e);
+      }
+
+      const std::size_t o{static_cast<std::size_t>(i)
+                        * static_cast<std::size_t>(k)};
+      R res{{{idx, o}, {dst, o}, k}, i};
+      for (T j{0}; j < k; ++j) {
+        res.idx[static_cast<std::size_t>(j)] = T{0};
+        res.dst[static_cast<std::size_t>(j)] = std::numeric_limits<F>::max();
+      }
+
+      walk<R, f_self, f_splitdim, F, T, dim, maj, Q, C_tree>(
+        res, q, tree, n, splitdim);
+
+      heapsort<T, dim, maj>(res.idx, res.dst, k);
+      kdtree::internal::knn::report<F>(ctx, res.dst, k);
+
+    }
+
+  });
+
+}
+
+// the single point of self_knn<K>, whatever the split dimensions.
+template <std::size_t K, typename F, typename T, T dim,
+          kdtree::container::layout maj, typename f_splitdim,
+          typename C_tree>
+constexpr std::array<T, K>
+one(const C_tree& tree, const T n, const T i, const f_splitdim& splitdim) {
+
+  using kdtree::container::id;
+  using kdtree::internal::knn::result_k_t;
+
+  using V = kdtree::container::get_primitive_t<C_tree>;
+  using Q = std::array<V, static_cast<std::size_t>(dim)>;
+  using R = self_t<result_k_t<F, T, K>, T>;
+
+  // see knn<K>.
+  using f_inner = std::conditional_t<(K <= 16),
+    kdtree::internal::knn::f_insert <F, T, dim, maj, Q, C_tree>,
+    kdtree::internal::knn::f_process<F, T, dim, maj, Q, C_tree>>;
+
+  using f_self = f_process<F, T, dim, maj, Q, C_tree, f_inner>;
+
+  Q q;
+  for (T e{0}; e < dim; ++e) {
+    q[static_cast<std::size_t>(e)] = id<T, dim, maj>(tree, n, i, e);
+  }
+
+  R res{{}, i};
+
+  walk<R, f_self, f_splitdim, F, T, dim, maj, Q, C_tree>(
+    res, q, tree, n, splitdim);
+
+  if constexpr (K > 16) {
+    kdtree::internal::knn::heapsort<T, dim, maj>(res.idx, res.dst, res.k);
+  }
+
+  return res.idx;
+
+}
+
+} // namespace self
+} // namespace internal
+} // namespace kdtree
+
+template<typename F, typename T, T dim, kdtree::container::layout maj,
+         typename C_tree, typename C_idx, typename C_dst>
+requires kdtree::container::container<C_tree>
+      && kdtree::container::container_1d<C_idx>
+      && kdtree::container::container_1d<C_dst>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_idx>, T>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_dst>, F>
+void
+kdtree::self_knn(const kdtree::context& ctx,
+                 const C_tree&         tree,
+                 const T               n,
+                 const T               k,
+                 C_idx&                idx,
+                 C_dst&                dst) {
+
+  using f_splitdim = kdtree::internal::traverse::f_splitdim<T, dim, maj,
+                                                            C_tree>;
+
+  kdtree::internal::self::rows<F, T, dim, maj>(ctx, tree, n, k, idx, dst,
+                                               f_splitdim{});
+
+}
+
+template<std::size_t K, typename F, typename T, T dim,
+         kdtree::container::layout maj, typename C_tree>
+requires kdtree::container::container<C_tree>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && (K > 0)
+constexpr std::array<T, K>
+kdtree::self_knn(const kdtree::query&   ctx,
+                 const C_tree&         tree,
+                 const T               n,
+                 const T               i) {
+
+  using f_splitdim = kdtree::internal::traverse::f_splitdim<T, dim, maj,
+                                                            C_tree>;
+
+  (void) ctx;
+
+  return kdtree::internal::self::one<K, F, T, dim, maj>(tree, n, i,
+                                                        f_splitdim{});
+
+}
+
+template<typename F, typename T, T dim, kdtree::container::layout maj,
+         typename C_tree, typename C_dim, typename C_idx, typename C_dst>
+requires kdtree::container::container<C_tree>
+      && kdtree::container::container_1d<C_dim>
+      && kdtree::container::container_1d<C_idx>
+      && kdtree::container::container_1d<C_dst>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_idx>, T>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_dst>, F>
+void
+kdtree::self_knn(const kdtree::context& ctx,
+                 const C_tree&         tree,
+                 const T               n,
+                 const C_dim&          dims,
+                 const T               k,
+                 C_idx&                idx,
+                 C_dst&                dst) {
+
+  using f_splitdim = kdtree::internal::traverse::f_splitdim_table<
+    T, dim, maj, C_tree, C_dim>;
+
+  kdtree::internal::self::rows<F, T, dim, maj>(ctx, tree, n, k, idx, dst,
+                                               f_splitdim{dims});
+
+}
+
+template<std::size_t K, typename F, typename T, T dim,
+         kdtree::container::layout maj, typename C_tree, typename C_dim>
+requires kdtree::container::container<C_tree>
+      && kdtree::container::container_1d<C_dim>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && (K > 0)
+constexpr std::array<T, K>
+kdtree::self_knn(const kdtree::query&   ctx,
+                 const C_tree&         tree,
+                 const T               n,
+                 const C_dim&          dims,
+                 const T               i) {
+
+  using f_splitdim = kdtree::internal::traverse::f_splitdim_table<
+    T, dim, maj, C_tree, C_dim>;
+
+  (void) ctx;
+
+  return kdtree::internal::self::one<K, F, T, dim, maj>(tree, n, i,
+                                                        f_splitdim{dims});
+
+}
+
+#endif // KDTREE_KNN_SELF_HPP
@@ -28,9 +28,12 @@
 
 #include "../pch.hpp"
 #include "../container.hpp"
+#include <limits>
 
 namespace kdtree {
 
+// with ctx.eps > 0 the neighbour returned is at most (1 + eps) times farther
+// than the nearest one.
 template<typename F, typename T, T dim,
          kdtree::container::layout maj = kdtree::container::layout::row_major,
          typename C_query, typename C_tree> 
@@ -41,9 +44,61 @@ requires kdtree::container::container_1d<C_query>
       && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
                         kdtree::container::get_primitive_t<C_tree>>
 T
-nn(const kdtree::context& ctx, const C_query& q, const C_tree& tree, 
+nn(const kdtree::query& ctx, const C_query& q, const C_tree& tree, 
    const T n, const F rmax = std::numeric_limits<F>::max());
 
+// also reports the squared distance of the neighbour in `dst`, or its
+// distance when ctx.euclidean is set. returns false when ctx.budget ran out
+// before the search finished, in which case the neighbour may not be exact.
+template<typename F, typename T, T dim,
+         kdtree::container::layout maj = kdtree::container::layout::row_major,
+         typename C_query, typename C_tree> 
+requires kdtree::container::container_1d<C_query> 
+      && kdtree::container::container<C_tree>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+bool
+nn(const kdtree::query& ctx, const C_query& q, const C_tree& tree, 
+   const T n, T& idx, F& dst, const F rmax = std::numeric_limits<F>::max());
+
+// warm start: the first `s` indices of `seed` are measured before the walk,
+// which then starts from the best of their distances as its bound. indices
+// outside the tree are ignored. otherwise as above.
+template<typename F, typename T, T dim,
+         kdtree::container::layout maj = kdtree::container::layout::row_major,
+         typename C_query, typename C_tree, typename C_seed> 
+requires kdtree::container::container_1d<C_query> 
+      && kdtree::container::container<C_tree>
+      && kdtree::container::container_1d<C_seed>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_seed>, T>
+bool
+nn(const kdtree::query& ctx, const C_query& q, const C_tree& tree, 
+   const T n, const C_seed& seed, const T s, T& idx, F& dst,
+   const F rmax = std::numeric_limits<F>::max());
+
+// for trees built with an adaptive create; `dims` holds the split dimension
+// of every node.
+template<typename F, typename T, T dim,
+         kdtree::container::layout maj = kdtree::container::layout::row_major,
+         typename C_query, typename C_tree, typename C_dim> 
+requires kdtree::container::container_1d<C_query> 
+      && kdtree::container::container<C_tree>
+      && kdtree::container::container_1d<C_dim>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+T
+nn(const kdtree::query& ctx, const C_query& q, const C_tree& tree, 
+   const T n, const C_dim& dims, 
+   const F rmax = std::numeric_limits<F>::max());
+
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -62,6 +117,7 @@ nn(const kdtree::context& ctx, const C_query& q, const C_tree& tree,
 
 #include "../traverse/traverse.hpp"
 #include "../internal/dist.hpp"
+#include "../internal/sqrt.hpp"
 
 namespace kdtree   {
 namespace internal {
@@ -104,6 +160,15 @@ struct f_process {
 
 };
 
+// see knn::report.
+template <typename F>
+requires std::is_arithmetic_v<F>
+inline F
+report(const kdtree::query& ctx, const F dst) {
+  if (!ctx.euclidean || !(dst < std::numeric_limits<F>::max())) return dst;
+  return kdtree::internal::sqrt(dst);
+}
+
 }  // namespace nn
 }  // namespace internal
 }  // namespace kdtree
@@ -117,24 +182,145 @@ requires kdtree::container::container_1d<C_query>
       && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
                         kdtree::container::get_primitive_t<C_tree>>
 T
-kdtree::nn(const kdtree::context& ctx, const C_query& q, const C_tree& tree, 
+kdtree::nn(const kdtree::query& ctx, const C_query& q, const C_tree& tree, 
            const T n, const F rmax) {
 
   using kdtree::internal::traverse::f_splitdim;
   using kdtree::internal::nn::f_process;
   using kdtree::internal::nn::result_t;
 
-  (void) ctx;
+  struct result_t<F, T> result;
+
+  kdtree::internal::traverse::run<
+    result_t<F, T>,
+    f_process<F, T, dim, maj, C_query, C_tree>,
+    f_splitdim<T, dim, maj, C_tree>,
+    F, T, dim, maj,
+    C_query, C_tree
+  >(ctx, result, q, tree, n, rmax);
+
+  return result.idx;
+
+}
+
+template<typename F, typename T, T dim, kdtree::container::layout maj,
+         typename C_query, typename C_tree> 
+requires kdtree::container::container_1d<C_query> 
+      && kdtree::container::container<C_tree>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+bool
+kdtree::nn(const kdtree::query& ctx, const C_query& q, const C_tree& tree, 
+           const T n, T& idx, F& dst, const F rmax) {
+
+  using kdtree::internal::traverse::f_splitdim;
+  using kdtree::internal::nn::f_process;
+  using kdtree::internal::nn::result_t;
+
+  struct result_t<F, T> result;
+
+  const bool exact = kdtree::internal::traverse::run<
+    result_t<F, T>,
+    f_process<F, T, dim, maj, C_query, C_tree>,
+    f_splitdim<T, dim, maj, C_tree>,
+    F, T, dim, maj,
+    C_query, C_tree
+  >(ctx, result, q, tree, n, rmax);
+
+  idx = result.idx;
+  dst = kdtree::internal::nn::report(ctx, result.dst);
+
+  return exact;
+
+}
+
+template<typename F, typename T, T dim, kdtree::container::layout maj,
+         typename C_query, typename C_tree, typename C_seed> 
+requires kdtree::container::container_1d<C_query> 
+      && kdtree::container::container<C_tree>
+      && kdtree::container::container_1d<C_seed>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_seed>, T>
+bool
+kdtree::nn(const kdtree::query& ctx, const C_query& q, const C_tree& tree, 
+           const T n, const C_seed& seed, const T s, T& idx, F& dst,
+           const F rmax) {
+
+  using kdtree::internal::dist::euclidian;
+  using kdtree::internal::traverse::f_splitdim;
+  using kdtree::internal::nn::f_process;
+  using kdtree::internal::nn::result_t;
 
   struct result_t<F, T> result;
 
-  kdtree::traverse<
+  // the seeds go through the same test as the points of the walk, which
+  // meets them again without effect: their distance is no longer smaller.
+
+  for (T j{0}; j < s; ++j) {
+    const T c{static_cast<T>(seed[static_cast<std::size_t>(j)])};
+    if constexpr (std::is_signed_v<T>) {
+      if (c < T{0}) continue;
+    }
+    if (!(c < n)) continue;
+    const F d{
+      euclidian<F, T, dim, maj, C_query, maj, C_tree>(q, 1, 0, tree, n, c)
+    };
+    if (d > F{0} && d < result.dst) {
+      result.dst = d;
+      result.idx = c;
+    }
+  }
+
+  const F bound{result.dst < rmax ? result.dst : rmax};
+
+  const bool exact = kdtree::internal::traverse::run<
     result_t<F, T>,
     f_process<F, T, dim, maj, C_query, C_tree>,
     f_splitdim<T, dim, maj, C_tree>,
     F, T, dim, maj,
     C_query, C_tree
-  > (result, q, tree, n, rmax);
+  >(ctx, result, q, tree, n, bound);
+
+  idx = result.idx;
+  dst = kdtree::internal::nn::report(ctx, result.dst);
+
+  return exact;
+
+}
+
+template<typename F, typename T, T dim, kdtree::container::layout maj,
+         typename C_query, typename C_tree, typename C_dim> 
+requires kdtree::container::container_1d<C_query> 
+      && kdtree::container::container<C_tree>
+      && kdtree::container::container_1d<C_dim>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+T
+kdtree::nn(const kdtree::query& ctx, const C_query& q, const C_tree& tree, 
+           const T n, const C_dim& dims, const F rmax) {
+
+  using kdtree::internal::traverse::f_splitdim_table;
+  using kdtree::internal::nn::f_process;
+  using kdtree::internal::nn::result_t;
+
+  struct result_t<F, T> result;
+
+  using f_splitdim = f_splitdim_table<T, dim, maj, C_tree, C_dim>;
+
+  kdtree::internal::traverse::run<
+    result_t<F, T>,
+    f_process<F, T, dim, maj, C_query, C_tree>,
+    f_splitdim,
+    F, T, dim, maj,
+    C_query, C_tree
+  >(ctx, result, q, tree, n, rmax, f_splitdim{dims});
 
   return result.idx;
 
@@ -35,6 +35,10 @@
 #include <concepts>
 #include <type_traits>
 #include <thread>
+#include <memory>
+#include <mutex>
+
+#include "internal/pool.hpp"
 
 // NOTE: tested for the following compilers
 #if defined(__INTEL_LLVM_COMPILER) || defined(__ADAPTIVECPP__) 
@@ -54,12 +58,61 @@
 
 #endif
 
+// depth-first queries keep their pending far subtrees on a short stack; the
+// stackless walk, which needs no per-query array, is used in device code and
+// in any build that defines KD__STACKLESS.
+#if defined(__SYCL_DEVICE_ONLY__) && !defined(KD__STACKLESS)
+  #define KD__STACKLESS
+#endif
+
 namespace kdtree {
 
-struct context {
-  std::size_t nthreads;
-  context() : nthreads(std::thread::hardware_concurrency()) {}
-  explicit context(std::size_t threads) : nthreads(threads) {}
+enum class sorter  { bitonic, radix, sample, merge };
+enum class builder { sort, select, presort };
+enum class walker  { depth, best };
+
+// the fields read by a single query. it is trivially copyable, so kernels
+// capture a `query` sliced off the context rather than the context itself.
+
+struct query {
+  bool           euclidean{false};        // queries: report true distances
+  bool           cell{false};             // queries: prune by cell distance
+  float          eps{0.0f};               // queries: (1 + eps)-approximate
+  // batch queries apply the budget to every query without reporting which
+  // ones it cut short, so their results may be approximate; the single
+  // query overloads return that flag.
+  std::size_t    budget{0};               // queries: max points, 0 for all
+  kdtree::walker walk{walker::depth};     // queries: traversal order
+};
+
+static_assert(std::is_trivially_copyable_v<query>);
+
+// copies of a context share its thread pool. the pool is started with
+// `nthreads` threads on the first call to pool(), so a context that only
+// runs queries starts none; changing `nthreads` after that has no effect.
+
+struct context : query {
+  std::size_t    nthreads;
+  bool           keys{false};             // create: sort (key, index) pairs
+  kdtree::sorter sort{sorter::bitonic};   // radix needs keyed payloads
+  kdtree::builder build{builder::sort};   // create: per-level strategy
+  std::size_t    local{std::size_t{1} << 14}; // create: serial subtree size
+  bool           fuse{true};              // create: retag inside split tasks
+  context() : context(std::thread::hardware_concurrency()) {}
+  explicit context(std::size_t threads) 
+    : nthreads(threads), workers(std::make_shared<workers_t>()) {}
+  kdtree::internal::pool& pool() const {
+    std::call_once(workers->once, [this] {
+      workers->pool = std::make_unique<kdtree::internal::pool>(nthreads);
+    });
+    return *workers->pool;
+  }
+private:
+  struct workers_t {
+    std::once_flag                          once;
+    std::unique_ptr<kdtree::internal::pool> pool;
+  };
+  std::shared_ptr<workers_t> workers;
 };
 
 } // namespace kdtree
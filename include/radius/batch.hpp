@@ -0,0 +1,140 @@
+/*!
+ * \file        radius/batch.hpp
+ * \author      Samridh D. Singh
+ * \date        2025-02-01
+ * \brief       batched fixed-radius search header and implementation
+ * \details     answers `m` radius queries in two parallel passes: the first
+ *              counts the hits of every query, a prefix sum turns the counts
+ *              into row offsets and the second pass fills the rows.
+ *
+ * \copyright   This file is part of the sycl_kdtree project.
+ * \copyright   Copyright (C) 2025, Samridh D. Singh
+ * \copyright
+ *              sycl_kdtree is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License as
+ *              published by the Free Software Foundation, either version 3 of
+ *              the License, or (at your option) any later version.
+ *
+ *              sycl_kdtree is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *              GNU General Public License for more details.
+ *
+ *              A copy of the GNU General Public License should be provided
+ *              along with sycl_kdtree.
+ *              If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef KDTREE_RADIUS_BATCH_HPP
+#define KDTREE_RADIUS_BATCH_HPP
+
+#include "../pch.hpp"
+#include "../container.hpp"
+
+#include <vector>
+
+namespace kdtree {
+
+// CSR output: the hits of query `i` are idx[off[i] .. off[i+1]) with their
+// squared distances (see ctx.euclidean) at the same positions of `dst`, in
+// no particular order. `queries` holds `m` points laid out like the tree.
+// the rows are always complete: ctx.budget does not apply.
+template<typename F, typename T, T dim,
+         kdtree::container::layout maj = kdtree::container::layout::row_major,
+         typename C_query, typename C_tree>
+requires kdtree::container::container<C_query>
+      && kdtree::container::container<C_tree>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+void
+radius_batch(const kdtree::context& ctx, const C_query& queries, const T m,
+             const C_tree& tree, const T n, const F r,
+             std::vector<T>& off, std::vector<T>& idx, std::vector<F>& dst);
+
+} // namespace kdtree
+
+///////////////////////////////////////////////////////////////////////////////
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                             IMPLEMENTATION                              ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "radius.hpp"
+
+#include <array>
+#include <cstddef>
+
+template<typename F, typename T, T dim, kdtree::container::layout maj,
+         typename C_query, typename C_tree>
+requires kdtree::container::container<C_query>
+      && kdtree::container::container<C_tree>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+void
+kdtree::radius_batch(const kdtree::context& ctx, const C_query& queries,
+                     const T m, const C_tree& tree, const T n, const F r,
+                     std::vector<T>& off, std::vector<T>& idx,
+                     std::vector<F>& dst) {
+
+  using kdtree::container::id;
+
+  using V = kdtree::container::get_primitive_t<C_tree>;
+  using Q = std::array<V, static_cast<std::size_t>(dim)>;
+
+  constexpr T grain{T{64}};
+
+  const auto load = [&](Q& q, const T i) {
+    for (T e{0}; e < dim; ++e) {
+      q[static_cast<std::size_t>(e)] = id<T, dim, maj>(queries, m, i, e);
+    }
+  };
+
+  // pass 1: off[i + 1] counts the hits of query `i`.
+
+  off.assign(static_cast<std::size_t>(m) + 1, T{0});
+
+  ctx.pool().parallel_for(T{0}, m, grain, [&](const T i0, const T i1) {
+    Q q;
+    for (T i{i0}; i < i1; ++i) {
+      load(q, i);
+      off[static_cast<std::size_t>(i) + 1] =
+        kdtree::radius_count<F, T, dim, maj>(ctx, q, tree, n, r);
+    }
+  });
+
+  for (std::size_t i{1}; i < off.size(); ++i) off[i] += off[i - 1];
+
+  // pass 2: every query writes exactly the row it counted.
+
+  idx.resize(static_cast<std::size_t>(off.back()));
+  dst.resize(static_cast<std::size_t>(off.back()));
+
+  ctx.pool().parallel_for(T{0}, m, grain, [&](const T i0, const T i1) {
+    Q q;
+    for (T i{i0}; i < i1; ++i) {
+      load(q, i);
+      const std::size_t j { static_cast<std::size_t>(i)      };
+      const std::size_t o { static_cast<std::size_t>(off[j]) };
+      const T           c { off[j + 1] - off[j]              };
+      kdtree::internal::knn::row_t<std::vector<T>> idx_{idx, o};
+      kdtree::internal::knn::row_t<std::vector<F>> dst_{dst, o};
+      kdtree::radius_search<F, T, dim, maj>(ctx, q, tree, n, r,
+                                            idx_, dst_, c);
+    }
+  });
+
+}
+
+#endif // KDTREE_RADIUS_BATCH_HPP
@@ -0,0 +1,235 @@
+/*!
+ * \file        radius/radius.hpp
+ * \author      Samridh D. Singh
+ * \date        2025-02-01
+ * \brief       fixed-radius search header and implementation
+ * \details     finds every point within distance `r` of a query. unlike nn
+ *              and knn the pruning bound never shrinks, and points at
+ *              distance zero are reported.
+ *
+ * \copyright   This file is part of the sycl_kdtree project.
+ * \copyright   Copyright (C) 2025, Samridh D. Singh
+ * \copyright
+ *              sycl_kdtree is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License as
+ *              published by the Free Software Foundation, either version 3 of
+ *              the License, or (at your option) any later version.
+ *
+ *              sycl_kdtree is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *              GNU General Public License for more details.
+ *
+ *              A copy of the GNU General Public License should be provided
+ *              along with sycl_kdtree.
+ *              If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef KDTREE_RADIUS_HPP
+#define KDTREE_RADIUS_HPP
+
+#include "../pch.hpp"
+#include "../container.hpp"
+
+namespace kdtree {
+
+// number of points of the tree within distance `r` of `q`. with ctx.eps > 0
+// the search is approximate: points within r / (1 + eps) are always found,
+// points farther than `r` never. ctx.budget does not apply: a count cut
+// short would be wrong, not approximate.
+template<typename F, typename T, T dim,
+         kdtree::container::layout maj = kdtree::container::layout::row_major,
+         typename C_query, typename C_tree>
+requires kdtree::container::container_1d<C_query>
+      && kdtree::container::container<C_tree>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+T
+radius_count(const kdtree::query& ctx, const C_query& q, const C_tree& tree,
+             const T n, const F r);
+
+// writes the first `cap` points found within distance `r` of `q` to `idx`
+// and their squared distances (see ctx.euclidean) to `dst`, in no particular
+// order. returns the number of points in range, which exceeds `cap` when
+// the output was truncated. ctx.budget does not apply, as for radius_count.
+template<typename F, typename T, T dim,
+         kdtree::container::layout maj = kdtree::container::layout::row_major,
+         typename C_query, typename C_tree, typename C_idx, typename C_dst>
+requires kdtree::container::container_1d<C_query>
+      && kdtree::container::container<C_tree>
+      && kdtree::container::container_1d<C_idx>
+      && kdtree::container::container_1d<C_dst>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_idx>, T>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_dst>, F>
+T
+radius_search(const kdtree::query& ctx, const C_query& q,
+              const C_tree& tree, const T n, const F r,
+              C_idx& idx, C_dst& dst, const T cap);
+
+} // namespace kdtree
+
+///////////////////////////////////////////////////////////////////////////////
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                             IMPLEMENTATION                              ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "../traverse/traverse.hpp"
+#include "../internal/dist.hpp"
+#include "../knn/knn.hpp"
+
+#include <cstddef>
+
+namespace kdtree   {
+namespace internal {
+namespace radius   {
+
+template <typename F, typename T>
+requires std::is_arithmetic_v<F> && std::is_integral_v<T>
+struct count_t {
+
+  const F r2;
+  T       count{0};
+
+  constexpr void
+  push(const T, const F) { ++count; }
+
+};
+
+// keeps the first `cap` hits and counts the rest.
+template <typename F, typename T, typename C_idx, typename C_dst>
+requires std::is_arithmetic_v<F> && std::is_integral_v<T>
+struct collect_t {
+
+  const F                             r2;
+  kdtree::internal::knn::row_t<C_idx> idx;
+  kdtree::internal::knn::row_t<C_dst> dst;
+  const T                             cap;
+  T                                   count{0};
+
+  constexpr void
+  push(const T i, const F d) {
+    if (count < cap) {
+      idx[static_cast<std::size_t>(count)] = i;
+      dst[static_cast<std::size_t>(count)] = d;
+    }
+    ++count;
+  }
+
+};
+
+// the bound handed to traverse is the squared radius and is left untouched.
+template <typename F, typename T, T dim, kdtree::container::layout maj,
+          typename C_query, typename C_tree>
+struct f_process {
+
+  template <typename result_t>
+  void
+  operator()(result_t& res, const C_query& q, const C_tree& src,
+             const T n, const T idx, F* rmax) const {
+
+    using kdtree::internal::dist::euclidian;
+
+    (void) rmax;
+
+    const F dst{
+      euclidian<F, T, dim, maj, C_query, maj, C_tree>(q, 1, 0, src, n, idx)
+    };
+
+    if (dst <= res.r2) {
+      res.push(idx, dst);
+    }
+
+  }
+
+};
+
+} // namespace radius
+} // namespace internal
+} // namespace kdtree
+
+template<typename F, typename T, T dim, kdtree::container::layout maj,
+         typename C_query, typename C_tree>
+requires kdtree::container::container_1d<C_query>
+      && kdtree::container::container<C_tree>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+T
+kdtree::radius_count(const kdtree::query& ctx, const C_query& q,
+                     const C_tree& tree, const T n, const F r) {
+
+  using kdtree::internal::traverse::f_splitdim;
+  using kdtree::internal::radius::f_process;
+  using kdtree::internal::radius::count_t;
+
+  count_t<F, T> result{r * r};
+
+  kdtree::internal::traverse::run<
+    count_t<F, T>,
+    f_process<F, T, dim, maj, C_query, C_tree>,
+    f_splitdim<T, dim, maj, C_tree>,
+    F, T, dim, maj,
+    C_query, C_tree
+  >(ctx, result, q, tree, n, result.r2, {}, false);
+
+  return result.count;
+
+}
+
+template<typename F, typename T, T dim, kdtree::container::layout maj,
+         typename C_query, typename C_tree, typename C_idx, typename C_dst>
+requires kdtree::container::container_1d<C_query>
+      && kdtree::container::container<C_tree>
+      && kdtree::container::container_1d<C_idx>
+      && kdtree::container::container_1d<C_dst>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_idx>, T>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_dst>, F>
+T
+kdtree::radius_search(const kdtree::query& ctx, const C_query& q,
+                      const C_tree& tree, const T n, const F r,
+                      C_idx& idx, C_dst& dst, const T cap) {
+
+  using kdtree::internal::traverse::f_splitdim;
+  using kdtree::internal::radius::f_process;
+  using kdtree::internal::radius::collect_t;
+
+  using R = collect_t<F, T, C_idx, C_dst>;
+
+  R result{r * r, {idx, 0}, {dst, 0}, cap};
+
+  kdtree::internal::traverse::run<
+    R,
+    f_process<F, T, dim, maj, C_query, C_tree>,
+    f_splitdim<T, dim, maj, C_tree>,
+    F, T, dim, maj,
+    C_query, C_tree
+  >(ctx, result, q, tree, n, result.r2, {}, false);
+
+  const T kept{result.count < cap ? result.count : cap};
+  kdtree::internal::knn::report<F>(ctx, result.dst, kept);
+
+  return result.count;
+
+}
+
+#endif // KDTREE_RADIUS_HPP
@@ -55,9 +55,9 @@ namespace bitonic {
 ///                                                                         ///
 ///////////////////////////////////////////////////////////////////////////////
 
-#include <future>
-#include <cmath>
-#include <functional>
+#include "simd.hpp"
+
+#include <iterator>
 #include <stdexcept>
 
 template <typename payload_t, typename T>
@@ -74,52 +74,74 @@ kdtree::bitonic::sort(const kdtree::context& ctx, payload_t& p,
 
   T n{n1 - n0};
 
-  std::size_t max_d { ctx.nthreads > 1
-                        ? static_cast<std::size_t>(std::log2(ctx.nthreads))
-                        : 0 };
-
-  std::function<void(T, T, bool, std::size_t)> bmerge =
-    [&](T lo, T hi, bool dir, std::size_t d) {
-      auto pow2_le_n{[&](T i) -> T {
-        T k = 1;
-        while (k > 0 && k < i)
-          k <<= 1;
-        return k >> 1;
-      }};
-      if (hi > 1) {
-        T m{pow2_le_n(hi)};
-        for (T i{lo}; i < lo + hi - m; ++i) {
-          if (dir == p.less(i + m, i))
-            p.swap(i + m, i);
-        }
-        if (d < max_d) {
-          auto fut{std::async(std::launch::async, bmerge, lo, m, dir, d + 1)};
-          bmerge(lo + m, hi - m, dir, d + 1);
-          fut.get();
-        } else {
-          bmerge(lo, m, dir, d + 1);
-          bmerge(lo + m, hi - m, dir, d + 1);
-        }
+  // below `grain` a subproblem stays on the thread that reached it; above it
+  // both halves go through the pool, which balances uneven splits.
+
+  constexpr T grain{T{1} << 11};
+
+  auto& pool{ctx.pool()};
+
+  const auto pow2_le_n{[](T i) -> T {
+    T k = 1;
+    while (k > 0 && k < i)
+      k <<= 1;
+    return k >> 1;
+  }};
+
+  // keyed payloads expose their arrays, so a step of the network can work on
+  // the keys directly and use the vector units when they are available.
+
+  const auto cmpswap{[&](T i0, T i1, T m, bool dir) {
+    if constexpr (kdtree::internal::sort::keyed_payload<payload_t>) {
+      kdtree::internal::sort::simd::cmpswap(std::data(p.key), 
+                                            std::data(p.idx), i0, i1, m, dir);
+    } else {
+      for (T i{i0}; i < i1; ++i) {
+        if (dir == p.less(i + m, i))
+          p.swap(i + m, i);
+      }
+    }
+  }};
+
+  const auto bmerge{[&](auto&& self, T lo, T hi, bool dir) -> void {
+    if constexpr (kdtree::internal::sort::keyed_payload<payload_t>) {
+      if (hi <= grain && (hi & (hi - T{1})) == T{0}) {
+        kdtree::internal::sort::simd::merge(std::data(p.key), 
+                                            std::data(p.idx), lo, hi, dir);
+        return;
       }
-    };
-
-  std::function<void(T, T, bool, std::size_t)> bsort {
-    [&](T lo, T hi, bool dir, std::size_t d) {
-      if (hi > 1) {
-        T m{hi / 2};
-        if (d < max_d) {
-          auto fut{std::async(std::launch::async, bsort, lo, m, !dir, d + 1)};
-          bsort(lo + m, hi - m, dir, d + 1);
-          fut.get();
-        } else {
-          bsort(lo, m, !dir, d + 1);
-          bsort(lo + m, hi - m, dir, d + 1);
-        }
-        bmerge(lo, hi, dir, d);
+    }
+    if (hi > 1) {
+      T m{pow2_le_n(hi)};
+      if (hi > grain) {
+        pool.parallel_for(lo, lo + hi - m, grain, [&](T i0, T i1) {
+          cmpswap(i0, i1, m, dir);
+        });
+        pool.invoke([&] { self(self, lo, m, dir); },
+                    [&] { self(self, lo + m, hi - m, dir); });
+      } else {
+        cmpswap(lo, lo + hi - m, m, dir);
+        self(self, lo, m, dir);
+        self(self, lo + m, hi - m, dir);
+      }
+    }
+  }};
+
+  const auto bsort{[&](auto&& self, T lo, T hi, bool dir) -> void {
+    if (hi > 1) {
+      T m{hi / 2};
+      if (hi > grain) {
+        pool.invoke([&] { self(self, lo, m, !dir); },
+                    [&] { self(self, lo + m, hi - m, dir); });
+      } else {
+        self(self, lo, m, !dir);
+        self(self, lo + m, hi - m, dir);
       }
-    }};
+      bmerge(bmerge, lo, hi, dir);
+    }
+  }};
 
-  bsort(n0, n, true, 0);
+  bsort(bsort, n0, n, true);
 
 }
 
@@ -28,6 +28,8 @@
 
 #include "../container.hpp"
 
+#include <iterator>
+
 namespace kdtree {
 namespace internal {
 namespace sort {
@@ -38,6 +40,19 @@ concept payload = requires(payload_t p_, std::size_t i_, std::size_t j_) {
   { p_.swap(i_, j_) } -> std::same_as<void>;
 };
 
+// payloads that also expose their contiguous (key, index) arrays, which lets
+// the non-comparison sorts move them directly.
+
+template <typename payload_t>
+concept keyed_payload = payload<payload_t> 
+  && requires(payload_t p_) {
+       { std::data(p_.key) };
+       { std::data(p_.idx) };
+     }
+  && std::is_unsigned_v<std::remove_cvref_t<
+       decltype(*std::data(std::declval<payload_t&>().key))
+     >>;
+
 } // namespace sort
 } // namespace internal
 } // namespace kdtree
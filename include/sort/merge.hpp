@@ -0,0 +1,163 @@
+/*!
+ * \file        sort/merge.hpp
+ * \author      Samridh D. Singh
+ * \date        2025-02-01
+ * \brief       in-place parallel merge sort
+ * \details     merges split their output at the middle diagonal of the merge
+ *              path, rotate the two inner runs into place and recurse on both
+ *              halves, so only `less` and `swap` are needed. this is not the
+ *              buffered merge-path merge, which moves each element once per
+ *              level: the rotations cost O(n log n) swaps per merge and
+ *              O(n log^2 n) per sort, in exchange for no allocation.
+ *
+ * \copyright   This file is part of the sycl_kdtree project.
+ * \copyright   Copyright (C) 2025, Samridh D. Singh
+ * \copyright   
+ *              sycl_kdtree is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License as
+ *              published by the Free Software Foundation, either version 3 of
+ *              the License, or (at your option) any later version.
+ *
+ *              sycl_kdtree is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *              GNU General Public License for more details.
+ *
+ *              A copy of the GNU General Public License should be provided
+ *              along with sycl_kdtree. 
+ *              If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef KDTREE_SORT_MERGE_HPP
+#define KDTREE_SORT_MERGE_HPP
+
+#include "../pch.hpp"
+#include "../container.hpp"
+#include "internal.hpp"
+
+namespace kdtree {
+namespace merge  {
+
+  template <typename payload_t, typename T>
+  requires kdtree::internal::sort::payload<payload_t> && std::integral<T>
+  void 
+  sort(const kdtree::context& ctx, payload_t& p, const T n0, const T n1);
+
+} // namespace merge
+} // namespace kdtree
+
+///////////////////////////////////////////////////////////////////////////////
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                             IMPLEMENTATION                              ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdexcept>
+
+template <typename payload_t, typename T>
+requires kdtree::internal::sort::payload<payload_t> && std::integral<T>
+void 
+kdtree::merge::sort(const kdtree::context& ctx, payload_t& p,
+                    const T n0, const T n1) {
+
+  if (n1 < n0) {
+    throw std::out_of_range("`n1` must be greater than `n0`.");
+  } else if (n1 == n0) {
+    return;
+  }
+
+  constexpr T small { 16          };
+  constexpr T grain { T{1} << 12  };
+
+  auto& pool{ctx.pool()};
+
+  // inserts [mid, hi) into the sorted run [lo, mid).
+  const auto insert{[&](const T lo, const T mid, const T hi) {
+    for (T i{mid}; i < hi; ++i) {
+      for (T j{i}; j > lo && p.less(j, j - T{1}); --j) {
+        p.swap(j, j - T{1});
+      }
+    }
+  }};
+
+  const auto reverse{[&](const T lo, const T hi) {
+    const T h{(hi - lo) / T{2}};
+    pool.parallel_for(T{0}, h, grain, [&](const T i0, const T i1) {
+      for (T i{i0}; i < i1; ++i) p.swap(lo + i, hi - T{1} - i);
+    });
+  }};
+
+  const auto merge{[&](auto&& self, const T lo, const T mid, 
+                       const T hi) -> void {
+
+    if (lo == mid || mid == hi || !p.less(mid, mid - T{1})) {
+      return;
+    } else if (hi - lo <= small) {
+      insert(lo, mid, hi);
+      return;
+    }
+
+    // the first k outputs take i elements of [lo, mid) and k - i of
+    // [mid, hi); equal elements come from the left run first.
+
+    const T na { mid - lo      };
+    const T nb { hi - mid      };
+    const T k  { (hi - lo) / 2 };
+
+    T i0 { k > nb ? k - nb : T{0} };
+    T i1 { k < na ? k      : na   };
+    while (i0 < i1) {
+      const T i{i0 + (i1 - i0) / T{2}};
+      if (!p.less(mid + (k - i) - T{1}, lo + i)) i0 = i + T{1};
+      else                                       i1 = i;
+    }
+
+    const T a { lo + i0          };
+    const T b { mid + (k - i0)   };
+    const T m { lo + k           };
+
+    if (a < mid && mid < b) {
+      reverse(a, mid);
+      reverse(mid, b);
+      reverse(a, b);
+    }
+
+    if (hi - lo > grain) {
+      pool.invoke([&] { self(self, lo, a, m); },
+                  [&] { self(self, m, m + (mid - a), hi); });
+    } else {
+      self(self, lo, a, m);
+      self(self, m, m + (mid - a), hi);
+    }
+
+  }};
+
+  const auto msort{[&](auto&& self, const T lo, const T hi) -> void {
+    if (hi - lo <= small) {
+      insert(lo, lo + T{1} < hi ? lo + T{1} : hi, hi);
+      return;
+    }
+    const T mid{lo + (hi - lo) / T{2}};
+    if (hi - lo > grain) {
+      pool.invoke([&] { self(self, lo, mid); },
+                  [&] { self(self, mid, hi); });
+    } else {
+      self(self, lo, mid);
+      self(self, mid, hi);
+    }
+    merge(merge, lo, mid, hi);
+  }};
+
+  msort(msort, n0, n1);
+
+}
+
+#endif // KDTREE_SORT_MERGE_HPP
@@ -38,6 +38,23 @@ namespace odd_even {
   void 
   sort(const kdtree::context& ctx, payload_t& p, const T n0, const T n1);
 
+  // the network on `n` elements runs stages (s, k) for s = 1, 2, 4, .. < n
+  // and k = s, s/2, .. 1. every comparator of a stage is independent, so a
+  // stage maps onto one parallel loop or one device kernel over `slots`.
+
+  template <typename T>
+  requires std::integral<T>
+  constexpr inline T
+  slots(const T n, const T s, const T k);
+
+  // comparator slot `t` of stage (s, k): orders (a, b) with a < b, or is
+  // idle and returns false.
+
+  template <typename T>
+  requires std::integral<T>
+  constexpr inline bool
+  comparator(const T n, const T s, const T k, const T t, T& a, T& b);
+
 } // namespace odd_even
 } // namespace kdtree
 
@@ -55,6 +72,32 @@ namespace odd_even {
 ///                                                                         ///
 ///////////////////////////////////////////////////////////////////////////////
 
+#include <stdexcept>
+
+template <typename T>
+requires std::integral<T>
+constexpr inline T
+kdtree::odd_even::slots(const T n, const T s, const T k) {
+  const T j0{k % s};
+  return (j0 + k < n) ? (n - j0 - k + T{2} * k - T{1}) / (T{2} * k) * k : T{0};
+}
+
+template <typename T>
+requires std::integral<T>
+constexpr inline bool
+kdtree::odd_even::comparator(const T n, const T s, const T k, const T t,
+                             T& a, T& b) {
+
+  // Batcher's merge for arbitrary n (Knuth 5.2.2, algorithm M): the pairs
+  // that would cross into the padding or into the next merge of width 2s
+  // are idle.
+
+  a = k % s + T{2} * k * (t / k) + t % k;
+  b = a + k;
+  return b < n && (a & ~(T{2} * s - T{1})) == (b & ~(T{2} * s - T{1}));
+
+}
+
 template <typename payload_t, typename T>
 requires kdtree::internal::sort::payload<payload_t> && std::integral<T>
 void 
@@ -67,30 +110,55 @@ kdtree::odd_even::sort(const kdtree::context& ctx, payload_t& p,
     return;
   }
 
-  (void) ctx;
-
-  using U = std::make_unsigned_t<T>;
-
-  bool is_sorted{false};
+  constexpr T grain { T{1} << 12 };
+  constexpr T block { T{1} << 12 };
 
-  while (!is_sorted) {
+  const T n{n1 - n0};
 
-    is_sorted = true;
+  // walks the slots of [t0, t1) like `comparator`, without its divisions.
 
-    for (U i{static_cast<U>(n0 + 1)}; i < static_cast<U>(n1 - 1); i += U(2)) {
-      if (p.less(i+1, i)) {
-        p.swap(i, i+1);
-        is_sorted = false;
+  const auto stage{[&](const T o, const T m, const T s, const T k, 
+                       const T t0, const T t1) {
+    const T w{static_cast<T>(~(T{2} * s - T{1}))};
+    T i{t0 % k};
+    T a{k % s + T{2} * k * (t0 / k) + i};
+    for (T t{t0}; t < t1 && a + k < m; ++t) {
+      const T b{a + k};
+      if ((a & w) == (b & w) && p.less(o + b, o + a)) {
+        p.swap(o + a, o + b);
+      }
+      ++a;
+      if (++i == k) {
+        i = T{0};
+        a += k;
       }
     }
-
-    for (U i{static_cast<U>(n0)}; i < static_cast<U>(n1 - 1); i += U(2)) {
-      if (p.less(i+1, i)) {
-        p.swap(i, i+1);
-        is_sorted = false;
+  }};
+
+  // comparators of the stages with 2s <= block never leave an aligned block,
+  // and the network is periodic in the block size, so those stages run as
+  // the same network on each block while it stays in cache.
+
+  const T nb{(n + block - T{1}) / block};
+  ctx.pool().parallel_for(T{0}, nb, T{1}, [&](const T b0, const T b1) {
+    for (T c{b0}; c < b1; ++c) {
+      const T o { n0 + c * block                         };
+      const T m { (n - c * block < block) ? n - c * block : block };
+      for (T s{1}; s < m; s *= T{2}) {
+        for (T k{s}; k > T{0}; k /= T{2}) {
+          stage(o, m, s, k, T{0}, slots(m, s, k));
+        }
       }
     }
-
+  });
+
+  for (T s{block}; s < n; s *= T{2}) {
+    for (T k{s}; k > T{0}; k /= T{2}) {
+      ctx.pool().parallel_for(T{0}, slots(n, s, k), grain, 
+                             [&](const T t0, const T t1) {
+        stage(n0, n, s, k, t0, t1);
+      });
+    }
   }
 
 }
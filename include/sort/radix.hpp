@@ -1,8 +1,8 @@
 /*!
- * \file        sort/sort.hpp
+ * \file        sort/radix.hpp
  * \author      Samridh D. Singh
  * \date        2025-02-01
- * \brief       containers for templates 
+ * \brief       containers for templates
  * \details     
  *
  * \copyright   This file is part of the sycl_kdtree project.
@@ -23,18 +23,164 @@
  *              If not, see <https://www.gnu.org/licenses/>.
  */
 
-#ifndef KDTREE_SORT_HPP
-#define KDTREE_SORT_HPP
+#ifndef KDTREE_SORT_RADIX_HPP
+#define KDTREE_SORT_RADIX_HPP
 
 #include "../pch.hpp"
 #include "../container.hpp"
 #include "internal.hpp"
 
 namespace kdtree {
+namespace radix  {
 
   template <typename payload_t, typename T>
-  requires kdtree::internal::sort::payload<payload_t> && std::integral<T>
+  requires kdtree::internal::sort::keyed_payload<payload_t> && std::integral<T>
   void 
   sort(const kdtree::context& ctx, payload_t& p, const T n0, const T n1);
 
+} // namespace radix
 } // namespace kdtree
+
+///////////////////////////////////////////////////////////////////////////////
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                             IMPLEMENTATION                              ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "bitonic.hpp"
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+template <typename payload_t, typename T>
+requires kdtree::internal::sort::keyed_payload<payload_t> && std::integral<T>
+void 
+kdtree::radix::sort(const kdtree::context& ctx, payload_t& p,
+                    const T n0, const T n1) {
+
+  if (n1 < n0) {
+    throw std::out_of_range("`n1` must be greater than `n0`.");
+  } else if (n1 == n0) {
+    return;
+  }
+
+  using K = std::remove_cvref_t<decltype(*std::data(p.key))>;
+  using I = std::remove_cvref_t<decltype(*std::data(p.idx))>;
+
+  constexpr std::size_t bits   { 8                             };
+  constexpr std::size_t nb     { std::size_t{1} << bits        };
+  constexpr std::size_t passes { CHAR_BIT * sizeof(K) / bits   };
+  constexpr K           mask   { static_cast<K>(nb - 1)        };
+  constexpr std::size_t grain  { std::size_t{1} << 14          };
+
+  using hist_t = std::array<std::size_t, nb>;
+
+  const std::size_t n{static_cast<std::size_t>(n1 - n0)};
+
+  if (n < nb) {
+    kdtree::bitonic::sort(ctx, p, n0, n1);
+    return;
+  }
+
+  const std::size_t nt { std::max<std::size_t>(1, 
+                           std::min<std::size_t>(ctx.pool().size(), n / grain)) };
+
+  const auto parallel = [&](auto&& f) {
+    ctx.pool().parallel_for(std::size_t{0}, nt, std::size_t{1},
+                           [&](const std::size_t t0, const std::size_t t1) {
+      for (std::size_t t{t0}; t < t1; ++t) f(t);
+    });
+  };
+
+  const auto lo = [&](const std::size_t t) { return n * t / nt;       };
+  const auto hi = [&](const std::size_t t) { return n * (t + 1) / nt; };
+
+  const std::unique_ptr<K[]> kbuf{new K[n]};
+  const std::unique_ptr<I[]> ibuf{new I[n]};
+
+  K* ks { std::data(p.key) + n0 };
+  I* is { std::data(p.idx) + n0 };
+  K* kd { kbuf.get()            };
+  I* id { ibuf.get()            };
+
+  // one sweep finds the digits every key shares; those passes are skipped.
+
+  K k_and{static_cast<K>(~K{0})};
+  K k_or {K{0}};
+  {
+    std::vector<std::array<K, 2>> acc(nt);
+    parallel([&](const std::size_t t) {
+      K a{static_cast<K>(~K{0})};
+      K o{K{0}};
+      for (std::size_t i{lo(t)}; i < hi(t); ++i) { a &= ks[i]; o |= ks[i]; }
+      acc[t] = {a, o};
+    });
+    for (const auto& a : acc) { k_and &= a[0]; k_or |= a[1]; }
+  }
+
+  std::vector<hist_t> hist(nt);
+
+  for (std::size_t pass{0}; pass < passes; ++pass) {
+
+    const std::size_t shift{pass * bits};
+
+    if ((((k_and ^ k_or) >> shift) & mask) == 0) {
+      continue;
+    }
+
+    parallel([&](const std::size_t t) {
+      hist[t].fill(0);
+      for (std::size_t i{lo(t)}; i < hi(t); ++i) {
+        ++hist[t][(ks[i] >> shift) & mask];
+      }
+    });
+
+    {
+      std::size_t s{0};
+      for (std::size_t b{0}; b < nb; ++b) {
+        for (std::size_t t{0}; t < nt; ++t) {
+          const std::size_t c{hist[t][b]};
+          hist[t][b] = s;
+          s += c;
+        }
+      }
+    }
+
+    parallel([&](const std::size_t t) {
+      hist_t& off{hist[t]};
+      for (std::size_t i{lo(t)}; i < hi(t); ++i) {
+        const std::size_t j{off[(ks[i] >> shift) & mask]++};
+        kd[j] = ks[i];
+        id[j] = is[i];
+      }
+    });
+
+    std::swap(ks, kd);
+    std::swap(is, id);
+
+  }
+
+  if (ks != std::data(p.key) + n0) {
+    parallel([&](const std::size_t t) {
+      for (std::size_t i{lo(t)}; i < hi(t); ++i) {
+        kd[i] = ks[i];
+        id[i] = is[i];
+      }
+    });
+  }
+
+}
+
+#endif // KDTREE_SORT_RADIX_HPP
@@ -0,0 +1,183 @@
+/*!
+ * \file        sort/sample.hpp
+ * \author      Samridh D. Singh
+ * \date        2025-02-01
+ * \brief       in-place parallel sample sort
+ * \details     sorted random splitters classify every element into a bucket,
+ *              the buckets are formed with one in-place permutation and then
+ *              sorted independently.
+ *
+ * \copyright   This file is part of the sycl_kdtree project.
+ * \copyright   Copyright (C) 2025, Samridh D. Singh
+ * \copyright   
+ *              sycl_kdtree is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License as
+ *              published by the Free Software Foundation, either version 3 of
+ *              the License, or (at your option) any later version.
+ *
+ *              sycl_kdtree is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *              GNU General Public License for more details.
+ *
+ *              A copy of the GNU General Public License should be provided
+ *              along with sycl_kdtree. 
+ *              If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef KDTREE_SORT_SAMPLE_HPP
+#define KDTREE_SORT_SAMPLE_HPP
+
+#include "../pch.hpp"
+#include "../container.hpp"
+#include "internal.hpp"
+
+namespace kdtree {
+namespace sample {
+
+  template <typename payload_t, typename T>
+  requires kdtree::internal::sort::payload<payload_t> && std::integral<T>
+  void 
+  sort(const kdtree::context& ctx, payload_t& p, const T n0, const T n1);
+
+} // namespace sample
+} // namespace kdtree
+
+///////////////////////////////////////////////////////////////////////////////
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                             IMPLEMENTATION                              ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "merge.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+template <typename payload_t, typename T>
+requires kdtree::internal::sort::payload<payload_t> && std::integral<T>
+void 
+kdtree::sample::sort(const kdtree::context& ctx, payload_t& p,
+                     const T n0, const T n1) {
+
+  if (n1 < n0) {
+    throw std::out_of_range("`n1` must be greater than `n0`.");
+  } else if (n1 == n0) {
+    return;
+  }
+
+  constexpr std::size_t over  { 16                     };
+  constexpr std::size_t grain { std::size_t{1} << 14   };
+
+  const std::size_t n{static_cast<std::size_t>(n1 - n0)};
+
+  if (n < 2 * grain) {
+    kdtree::merge::sort(ctx, p, n0, n1);
+    return;
+  }
+
+  const std::size_t nb { std::clamp<std::size_t>(8 * ctx.pool().size(), 
+                                                 16, 256)              };
+  const std::size_t ns { nb * over                                     };
+  const std::size_t nt { std::max<std::size_t>(1, 
+                           std::min<std::size_t>(ctx.pool().size(), n / grain)) };
+
+  const auto parallel = [&](auto&& f) {
+    ctx.pool().parallel_for(std::size_t{0}, nt, std::size_t{1},
+                           [&](const std::size_t t0, const std::size_t t1) {
+      for (std::size_t t{t0}; t < t1; ++t) f(t);
+    });
+  };
+
+  const auto lo = [&](const std::size_t t) { return n * t / nt;       };
+  const auto hi = [&](const std::size_t t) { return n * (t + 1) / nt; };
+  const auto at = [&](const std::size_t i) { return static_cast<T>(n0 + i); };
+
+  // a fixed-seed partial shuffle moves `ns` random elements to the front;
+  // once sorted, every `over`-th of them is a splitter. the splitters are
+  // not moved again until every element has been classified.
+
+  {
+    std::uint64_t s{0x9e3779b97f4a7c15ull ^ n};
+    for (std::size_t i{0}; i < ns; ++i) {
+      s ^= s << 13; s ^= s >> 7; s ^= s << 17;
+      const std::size_t j{i + static_cast<std::size_t>(s % (n - i))};
+      if (j != i) p.swap(at(i), at(j));
+    }
+    kdtree::merge::sort(ctx, p, at(0), at(ns));
+  }
+
+  std::vector<T> spl(nb - 1);
+  for (std::size_t b{0}; b + 1 < nb; ++b) spl[b] = at((b + 1) * over - 1);
+
+  // bucket of element i = number of splitters not greater than it.
+
+  const std::unique_ptr<std::uint8_t[]> bkt{new std::uint8_t[n]};
+  std::vector<std::vector<std::size_t>> hist(nt, 
+                                             std::vector<std::size_t>(nb, 0));
+
+  parallel([&](const std::size_t t) {
+    for (std::size_t i{lo(t)}; i < hi(t); ++i) {
+      std::size_t b0{0};
+      std::size_t b1{nb - 1};
+      while (b0 < b1) {
+        const std::size_t b{(b0 + b1) / 2};
+        if (p.less(at(i), spl[b])) b1 = b;
+        else                       b0 = b + 1;
+      }
+      bkt[i] = static_cast<std::uint8_t>(b0);
+      ++hist[t][b0];
+    }
+  });
+
+  std::vector<std::size_t> beg(nb + 1, 0);
+  {
+    std::size_t s{0};
+    for (std::size_t b{0}; b < nb; ++b) {
+      beg[b] = s;
+      for (std::size_t t{0}; t < nt; ++t) {
+        const std::size_t c{hist[t][b]};
+        hist[t][b] = s;
+        s += c;
+      }
+    }
+    beg[nb] = s;
+  }
+
+  const std::unique_ptr<std::size_t[]> dst{new std::size_t[n]};
+  parallel([&](const std::size_t t) {
+    for (std::size_t i{lo(t)}; i < hi(t); ++i) dst[i] = hist[t][bkt[i]]++;
+  });
+
+  // the scatter is a single permutation, applied in place by walking its
+  // cycles; every element is swapped into its bucket exactly once.
+
+  for (std::size_t i{0}; i < n; ++i) {
+    while (dst[i] != i) {
+      const std::size_t j{dst[i]};
+      p.swap(at(i), at(j));
+      std::swap(dst[i], dst[j]);
+    }
+  }
+
+  ctx.pool().parallel_for(std::size_t{0}, nb, std::size_t{1},
+                         [&](const std::size_t b0, const std::size_t b1) {
+    for (std::size_t b{b0}; b < b1; ++b) {
+      kdtree::merge::sort(ctx, p, at(beg[b]), at(beg[b + 1]));
+    }
+  });
+
+}
+
+#endif // KDTREE_SORT_SAMPLE_HPP
@@ -0,0 +1,244 @@
+/*!
+ * \file        sort/select.hpp
+ * \author      Samridh D. Singh
+ * \date        2025-02-01
+ * \brief       selection of a single rank over a payload
+ * \details     introselect: quickselect that falls back to kdtree::sort when
+ *              the partitions stop shrinking. ranges of two blocks of
+ *              internal::select::grain or more are partitioned on the pool.
+ *
+ * \copyright   This file is part of the sycl_kdtree project.
+ * \copyright   Copyright (C) 2025, Samridh D. Singh
+ * \copyright   
+ *              sycl_kdtree is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License as
+ *              published by the Free Software Foundation, either version 3 of
+ *              the License, or (at your option) any later version.
+ *
+ *              sycl_kdtree is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *              GNU General Public License for more details.
+ *
+ *              A copy of the GNU General Public License should be provided
+ *              along with sycl_kdtree. 
+ *              If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef KDTREE_SORT_SELECT_HPP
+#define KDTREE_SORT_SELECT_HPP
+
+#include "../pch.hpp"
+#include "../container.hpp"
+#include "internal.hpp"
+
+namespace kdtree {
+
+  // moves the element of rank `nk - n0` in [n0, n1) to `nk`, with nothing
+  // greater before it and nothing smaller after it.
+
+  template <typename payload_t, typename T>
+  requires kdtree::internal::sort::payload<payload_t> && std::integral<T>
+  void 
+  select(const kdtree::context& ctx, payload_t& p, 
+         const T n0, const T nk, const T n1);
+
+} // namespace kdtree
+
+///////////////////////////////////////////////////////////////////////////////
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                             IMPLEMENTATION                              ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "sort.hpp"
+#include "../internal/bsr.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace kdtree   {
+namespace internal {
+namespace select   {
+
+// the smallest block a task partitions; shorter ranges stay serial.
+constexpr std::size_t grain{std::size_t{1} << 12};
+
+// partitions (lo, hi) around the pivot at `lo` in `nt` blocks and moves the
+// pivot to its final place, which is returned. each block is partitioned on
+// its own; the large elements then left before the boundary are swapped
+// with the small ones behind it, a chunk of pairs per task. ties go left in
+// odd blocks and right in even ones, so that runs of equal keys still split.
+
+template <typename payload_t, typename T>
+T
+partition(const kdtree::context& ctx, payload_t& p, const T lo, const T hi,
+          const std::size_t nt) {
+
+  const T           s { lo + T{1}                         };
+  const std::size_t n { static_cast<std::size_t>(hi - s) };
+
+  const auto beg = [&](const std::size_t t) {
+    return static_cast<T>(s + static_cast<T>(n * t / nt));
+  };
+
+  std::vector<T> cnt(nt);
+
+  ctx.pool().parallel_for(std::size_t{0}, nt, std::size_t{1},
+                         [&](const std::size_t t0, const std::size_t t1) {
+    for (std::size_t t{t0}; t < t1; ++t) {
+      const bool ties{t % 2 == 1};
+      const auto left = [&](const T i) {
+        return p.less(i, lo) || (ties && !p.less(lo, i));
+      };
+      T i{beg(t)};
+      T j{beg(t + 1)};
+      while (1) {
+        while (i < j &&  left(i))         ++i;
+        while (i < j && !left(j - T{1})) --j;
+        if (i >= j) break;
+        p.swap(i++, --j);
+      }
+      cnt[t] = i - beg(t);
+    }
+  });
+
+  T m{s};
+  for (const T c : cnt) m += c;
+
+  // the misplaced runs of every block: large elements in [s, m), small ones
+  // in [m, hi). there are as many of one as of the other.
+
+  struct run_t { T at; T len; };
+
+  std::vector<run_t> big;
+  std::vector<run_t> sml;
+  T                  nm{0};
+
+  for (std::size_t t{0}; t < nt; ++t) {
+    const T b0{beg(t)};
+    const T bm{b0 + cnt[t]};
+    const T b1{beg(t + 1)};
+    if (std::max(bm, s) < std::min(b1, m)) {
+      big.push_back({std::max(bm, s), std::min(b1, m) - std::max(bm, s)});
+      nm += big.back().len;
+    }
+    if (std::max(b0, m) < std::min(bm, hi)) {
+      sml.push_back({std::max(b0, m), std::min(bm, hi) - std::max(b0, m)});
+    }
+  }
+
+  ctx.pool().parallel_for(T{0}, nm, static_cast<T>(grain), 
+                          [&](const T k0, const T k1) {
+    std::size_t a{0};
+    std::size_t b{0};
+    T           ka{k0};
+    T           kb{k0};
+    while (ka >= big[a].len) ka -= big[a++].len;
+    while (kb >= sml[b].len) kb -= sml[b++].len;
+    for (T k{k0}; k < k1; ++k) {
+      p.swap(big[a].at + ka, sml[b].at + kb);
+      if (++ka == big[a].len) { ka = T{0}; ++a; }
+      if (++kb == sml[b].len) { kb = T{0}; ++b; }
+    }
+  });
+
+  const T j{m - T{1}};
+  if (j != lo) p.swap(lo, j);
+  return j;
+
+}
+
+} // namespace select
+} // namespace internal
+} // namespace kdtree
+
+template <typename payload_t, typename T>
+requires kdtree::internal::sort::payload<payload_t> && std::integral<T>
+void 
+kdtree::select(const kdtree::context& ctx, payload_t& p, 
+               const T n0, const T nk, const T n1) {
+
+  if (n1 < n0) {
+    throw std::out_of_range("`n1` must be greater than `n0`.");
+  } else if (nk < n0 || nk >= n1) {
+    throw std::out_of_range("`nk` must lie in [`n0`, `n1`).");
+  }
+
+  using kdtree::internal::select::grain;
+
+  constexpr T small{16};
+
+  // quickselect, median of three. the partition rounds share one budget of
+  // 2 (floor(log2(n)) + 1), counted whether or not a round shrinks the range
+  // much; a range still above `small` when it runs out is handed to
+  // kdtree::sort, which bounds the worst case.
+
+  T lo{n0};
+  T hi{n1};
+  T budget{T{2} * (kdtree::internal::bsr(n1 - n0) + T{1})};
+
+  while (hi - lo > small) {
+
+    if (budget-- == T{0}) {
+      kdtree::sort(ctx, p, lo, hi);
+      return;
+    }
+
+    {
+      const T mid{lo + (hi - lo) / T{2}};
+      if (p.less(mid, lo))     p.swap(mid, lo);
+      if (p.less(hi - 1, lo))  p.swap(hi - 1, lo);
+      if (p.less(hi - 1, mid)) p.swap(hi - 1, mid);
+      p.swap(lo, mid);
+    }
+
+    // large ranges, which the top levels of a build consist of, are
+    // partitioned on the pool; see internal::select::partition.
+
+    const std::size_t m  { static_cast<std::size_t>(hi - lo) };
+    const std::size_t nt { m < 2 * grain ? 1 
+                             : std::min(ctx.pool().size(), m / grain) };
+
+    T j{hi};
+    if (nt > 1) {
+      j = kdtree::internal::select::partition(ctx, p, lo, hi, nt);
+    } else {
+      T i{lo};
+      while (1) {
+        while (p.less(++i, lo)) if (i == hi - T{1}) break;
+        while (p.less(lo, --j)) if (j == lo)        break;
+        if (i >= j) break;
+        p.swap(i, j);
+      }
+      p.swap(lo, j);
+    }
+
+    if (j == nk) {
+      return;
+    } else if (nk < j) {
+      hi = j;
+    } else {
+      lo = j + T{1};
+    }
+
+  }
+
+  for (T i{lo + T{1}}; i < hi; ++i) {
+    for (T j{i}; j > lo && p.less(j, j - T{1}); --j) {
+      p.swap(j, j - T{1});
+    }
+  }
+
+}
+
+#endif // KDTREE_SORT_SELECT_HPP
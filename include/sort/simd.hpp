@@ -0,0 +1,311 @@
+/*!
+ * \file        sort/simd.hpp
+ * \author      Samridh D. Singh
+ * \date        2025-02-01
+ * \brief       vectorized compare-exchange for contiguous keys
+ * \details     one step of a sorting network over (key, index) arrays. AVX-512
+ *              and AVX2 handle 16/8 32-bit or 8/4 64-bit keys per step when
+ *              the compiler targets them; everything else runs scalar.
+ *
+ * \copyright   This file is part of the sycl_kdtree project.
+ * \copyright   Copyright (C) 2025, Samridh D. Singh
+ * \copyright   
+ *              sycl_kdtree is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License as
+ *              published by the Free Software Foundation, either version 3 of
+ *              the License, or (at your option) any later version.
+ *
+ *              sycl_kdtree is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *              GNU General Public License for more details.
+ *
+ *              A copy of the GNU General Public License should be provided
+ *              along with sycl_kdtree. 
+ *              If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef KDTREE_SORT_SIMD_HPP
+#define KDTREE_SORT_SIMD_HPP
+
+#include "../pch.hpp"
+
+#include <type_traits>
+
+namespace kdtree   {
+namespace internal {
+namespace sort     {
+namespace simd     {
+
+// for every i in [i0, i1) orders (key[i], key[i + m]) ascending if `dir`,
+// descending otherwise, moving idx along. the two ranges must not overlap.
+
+template <typename K, typename I, typename T>
+requires std::is_unsigned_v<K> && std::is_integral_v<T>
+inline void
+cmpswap(K* key, I* idx, const T i0, const T i1, const T m, const bool dir);
+
+// bitonic merge of the 2^k elements starting at `lo`. the strides that fit
+// in a vector register are finished in registers.
+
+template <typename K, typename I, typename T>
+requires std::is_unsigned_v<K> && std::is_integral_v<T>
+inline void
+merge(K* key, I* idx, const T lo, const T hi, const bool dir);
+
+} // namespace simd
+} // namespace sort
+} // namespace internal
+} // namespace kdtree
+
+///////////////////////////////////////////////////////////////////////////////
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                             IMPLEMENTATION                              ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///////////////////////////////////////////////////////////////////////////////
+
+#if !defined(__SYCL_DEVICE_ONLY__) \
+    && (defined(__AVX2__) || defined(__AVX512F__))
+#define KD__SIMD_X86
+#include <immintrin.h>
+#endif
+
+#include <utility>
+
+template <typename K, typename I, typename T>
+requires std::is_unsigned_v<K> && std::is_integral_v<T>
+inline void
+kdtree::internal::sort::simd::cmpswap(K* key, I* idx, const T i0, const T i1, 
+                                      const T m, const bool dir) {
+
+  T i{i0};
+
+  #if defined(KD__SIMD_X86)
+
+  [[maybe_unused]] constexpr bool u32{sizeof(K) == 4 && sizeof(I) == 4};
+  [[maybe_unused]] constexpr bool u64{sizeof(K) == 8 && sizeof(I) == 4};
+
+  // the swap mask is `key[i + m] < key[i]`, inverted for descending runs.
+
+  #if defined(__AVX512F__)
+
+  if constexpr (u32) {
+    for (; i + T{16} <= i1; i += T{16}) {
+      K* ka{key + i}; K* kb{ka + m};
+      I* ia{idx + i}; I* ib{ia + m};
+      const __m512i a  { _mm512_loadu_si512(ka) };
+      const __m512i b  { _mm512_loadu_si512(kb) };
+      const __m512i xa { _mm512_loadu_si512(ia) };
+      const __m512i xb { _mm512_loadu_si512(ib) };
+      __mmask16 s{_mm512_cmplt_epu32_mask(b, a)};
+      if (!dir) s = static_cast<__mmask16>(~s);
+      _mm512_storeu_si512(ka, _mm512_mask_blend_epi32(s, a, b));
+      _mm512_storeu_si512(kb, _mm512_mask_blend_epi32(s, b, a));
+      _mm512_storeu_si512(ia, _mm512_mask_blend_epi32(s, xa, xb));
+      _mm512_storeu_si512(ib, _mm512_mask_blend_epi32(s, xb, xa));
+    }
+  }
+
+  #if defined(__AVX512VL__)
+  if constexpr (u64) {
+    for (; i + T{8} <= i1; i += T{8}) {
+      K* ka{key + i}; K* kb{ka + m};
+      I* ia{idx + i}; I* ib{ia + m};
+      const __m512i a  { _mm512_loadu_si512(ka) };
+      const __m512i b  { _mm512_loadu_si512(kb) };
+      const __m256i xa { _mm256_loadu_si256(reinterpret_cast<__m256i*>(ia)) };
+      const __m256i xb { _mm256_loadu_si256(reinterpret_cast<__m256i*>(ib)) };
+      __mmask8 s{_mm512_cmplt_epu64_mask(b, a)};
+      if (!dir) s = static_cast<__mmask8>(~s);
+      _mm512_storeu_si512(ka, _mm512_mask_blend_epi64(s, a, b));
+      _mm512_storeu_si512(kb, _mm512_mask_blend_epi64(s, b, a));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(ia), 
+                          _mm256_mask_blend_epi32(s, xa, xb));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(ib), 
+                          _mm256_mask_blend_epi32(s, xb, xa));
+    }
+  }
+  #endif
+
+  #endif // __AVX512F__
+
+  #if defined(__AVX2__)
+
+  // avx2 only compares signed lanes, so both sides are biased by the msb.
+
+  const __m256i inv{_mm256_set1_epi32(dir ? 0 : -1)};
+
+  if constexpr (u32) {
+    const __m256i bias{_mm256_set1_epi32(static_cast<int>(0x80000000u))};
+    for (; i + T{8} <= i1; i += T{8}) {
+      __m256i* ka{reinterpret_cast<__m256i*>(key + i)};
+      __m256i* kb{reinterpret_cast<__m256i*>(key + i + m)};
+      __m256i* ia{reinterpret_cast<__m256i*>(idx + i)};
+      __m256i* ib{reinterpret_cast<__m256i*>(idx + i + m)};
+      const __m256i a  { _mm256_loadu_si256(ka) };
+      const __m256i b  { _mm256_loadu_si256(kb) };
+      const __m256i xa { _mm256_loadu_si256(ia) };
+      const __m256i xb { _mm256_loadu_si256(ib) };
+      const __m256i s  { _mm256_xor_si256(inv, _mm256_cmpgt_epi32(
+                           _mm256_xor_si256(a, bias), 
+                           _mm256_xor_si256(b, bias))) };
+      _mm256_storeu_si256(ka, _mm256_blendv_epi8(a, b, s));
+      _mm256_storeu_si256(kb, _mm256_blendv_epi8(b, a, s));
+      _mm256_storeu_si256(ia, _mm256_blendv_epi8(xa, xb, s));
+      _mm256_storeu_si256(ib, _mm256_blendv_epi8(xb, xa, s));
+    }
+  }
+
+  if constexpr (u64) {
+    const __m256i bias{_mm256_set1_epi64x(static_cast<long long>(
+                         0x8000000000000000ull))};
+    const __m256i lo32{_mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6)};
+    for (; i + T{4} <= i1; i += T{4}) {
+      __m256i* ka{reinterpret_cast<__m256i*>(key + i)};
+      __m256i* kb{reinterpret_cast<__m256i*>(key + i + m)};
+      __m128i* ia{reinterpret_cast<__m128i*>(idx + i)};
+      __m128i* ib{reinterpret_cast<__m128i*>(idx + i + m)};
+      const __m256i a  { _mm256_loadu_si256(ka) };
+      const __m256i b  { _mm256_loadu_si256(kb) };
+      const __m128i xa { _mm_loadu_si128(ia)    };
+      const __m128i xb { _mm_loadu_si128(ib)    };
+      const __m256i s  { _mm256_xor_si256(inv, _mm256_cmpgt_epi64(
+                           _mm256_xor_si256(a, bias), 
+                           _mm256_xor_si256(b, bias))) };
+      const __m128i t  { _mm256_castsi256_si128(
+                           _mm256_permutevar8x32_epi32(s, lo32)) };
+      _mm256_storeu_si256(ka, _mm256_blendv_epi8(a, b, s));
+      _mm256_storeu_si256(kb, _mm256_blendv_epi8(b, a, s));
+      _mm_storeu_si128(ia, _mm_blendv_epi8(xa, xb, t));
+      _mm_storeu_si128(ib, _mm_blendv_epi8(xb, xa, t));
+    }
+  }
+
+  #endif // __AVX2__
+
+  #endif // KD__SIMD_X86
+
+  for (; i < i1; ++i) {
+    if (dir == (key[i + m] < key[i])) {
+      std::swap(key[i + m], key[i]);
+      std::swap(idx[i + m], idx[i]);
+    }
+  }
+
+}
+
+template <typename K, typename I, typename T>
+requires std::is_unsigned_v<K> && std::is_integral_v<T>
+inline void
+kdtree::internal::sort::simd::merge(K* key, I* idx, const T lo, const T hi, 
+                                    const bool dir) {
+
+  T m{hi / T{2}};
+
+  #if defined(KD__SIMD_X86)
+
+  [[maybe_unused]] constexpr bool u32{sizeof(K) == 4 && sizeof(I) == 4};
+
+  // lanes whose stride bit is clear keep the min of the pair when ascending;
+  // both lanes of a pair agree on the result, ties included.
+
+  #if defined(__AVX512F__)
+
+  if constexpr (u32) {
+    if (hi >= T{16}) {
+      for (; m >= T{16}; m /= T{2}) {
+        for (T b{lo}; b < lo + hi; b += T{2} * m) {
+          cmpswap(key, idx, b, b + m, m, dir);
+        }
+      }
+      const __m512i lane{_mm512_setr_epi32(0, 1, 2,  3,  4,  5,  6,  7, 
+                                           8, 9, 10, 11, 12, 13, 14, 15)};
+      for (T b{lo}; b < lo + hi; b += T{16}) {
+        __m512i k { _mm512_loadu_si512(key + b) };
+        __m512i x { _mm512_loadu_si512(idx + b) };
+        // the masked permute with a full mask is the same instruction; the
+        // unmasked one passes GCC an undefined vector to merge into.
+        for (int s{8}; s > 0; s /= 2) {
+          const __m512i  sv { _mm512_set1_epi32(s)                        };
+          const __m512i  pv { _mm512_xor_si512(lane, sv)                  };
+          const __m512i  pk { _mm512_mask_permutexvar_epi32(
+                                k, __mmask16(0xffff), pv, k)              };
+          const __m512i  px { _mm512_mask_permutexvar_epi32(
+                                x, __mmask16(0xffff), pv, x)              };
+          const __mmask16 lw { _mm512_testn_epi32_mask(lane, sv)          };
+          const __mmask16 mn { static_cast<__mmask16>(dir ? lw : ~lw)     };
+          const __mmask16 t  { static_cast<__mmask16>(
+                                 (mn & _mm512_cmplt_epu32_mask(pk, k)) |
+                                 (~mn & _mm512_cmpgt_epu32_mask(pk, k)))  };
+          k = _mm512_mask_blend_epi32(t, k, pk);
+          x = _mm512_mask_blend_epi32(t, x, px);
+        }
+        _mm512_storeu_si512(key + b, k);
+        _mm512_storeu_si512(idx + b, x);
+      }
+      return;
+    }
+  }
+
+  #elif defined(__AVX2__)
+
+  if constexpr (u32) {
+    if (hi >= T{8}) {
+      for (; m >= T{8}; m /= T{2}) {
+        for (T b{lo}; b < lo + hi; b += T{2} * m) {
+          cmpswap(key, idx, b, b + m, m, dir);
+        }
+      }
+      const __m256i lane{_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)};
+      const __m256i bias{_mm256_set1_epi32(static_cast<int>(0x80000000u))};
+      const __m256i inv {_mm256_set1_epi32(dir ? 0 : -1)};
+      for (T b{lo}; b < lo + hi; b += T{8}) {
+        __m256i* kp{reinterpret_cast<__m256i*>(key + b)};
+        __m256i* xp{reinterpret_cast<__m256i*>(idx + b)};
+        __m256i k { _mm256_loadu_si256(kp) };
+        __m256i x { _mm256_loadu_si256(xp) };
+        for (int s{4}; s > 0; s /= 2) {
+          const __m256i sv { _mm256_set1_epi32(s)                             };
+          const __m256i pm { _mm256_xor_si256(lane, sv)                       };
+          const __m256i pk { _mm256_permutevar8x32_epi32(k, pm)               };
+          const __m256i px { _mm256_permutevar8x32_epi32(x, pm)               };
+          const __m256i lw { _mm256_cmpeq_epi32(_mm256_and_si256(lane, sv),
+                                                _mm256_setzero_si256())      };
+          const __m256i mn { _mm256_xor_si256(lw, inv)                        };
+          const __m256i bk { _mm256_xor_si256(k,  bias)                       };
+          const __m256i bp { _mm256_xor_si256(pk, bias)                       };
+          const __m256i lt { _mm256_cmpgt_epi32(bk, bp)                       };
+          const __m256i gt { _mm256_cmpgt_epi32(bp, bk)                       };
+          const __m256i t  { _mm256_or_si256(_mm256_and_si256(mn, lt),
+                                             _mm256_andnot_si256(mn, gt))     };
+          k = _mm256_blendv_epi8(k, pk, t);
+          x = _mm256_blendv_epi8(x, px, t);
+        }
+        _mm256_storeu_si256(kp, k);
+        _mm256_storeu_si256(xp, x);
+      }
+      return;
+    }
+  }
+
+  #endif
+
+  #endif // KD__SIMD_X86
+
+  for (; m > T{0}; m /= T{2}) {
+    for (T b{lo}; b < lo + hi; b += T{2} * m) {
+      cmpswap(key, idx, b, b + m, m, dir);
+    }
+  }
+
+}
+
+#endif // KDTREE_SORT_SIMD_HPP
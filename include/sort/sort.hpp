@@ -55,6 +55,9 @@ namespace kdtree {
 
 #include "bitonic.hpp"
 #include "odd_even.hpp"
+#include "radix.hpp"
+#include "sample.hpp"
+#include "merge.hpp"
 
 template <typename payload_t, typename T>
 requires kdtree::internal::sort::payload<payload_t> && std::integral<T>
@@ -68,17 +71,34 @@ kdtree::sort(const kdtree::context& ctx, payload_t& p,
     return;
   } 
 
-  (void) ctx;
+  if constexpr (kdtree::internal::sort::keyed_payload<payload_t>) {
+    if (ctx.sort == kdtree::sorter::radix) {
+      kdtree::radix::sort(ctx, p, n0, n1);
+      return;
+    }
+  }
+
+  if (ctx.sort == kdtree::sorter::sample) {
+    kdtree::sample::sort(ctx, p, n0, n1);
+    return;
+  } else if (ctx.sort == kdtree::sorter::merge) {
+    kdtree::merge::sort(ctx, p, n0, n1);
+    return;
+  }
 
   const T n{n1 - n0}; 
 
+  // batcher's network needs fewer comparators than bitonic off powers of
+  // two; keyed payloads stay on bitonic, whose steps are vectorized.
+
   if ((n & (n - 1)) == 0) { 
     kdtree::bitonic::sort(ctx, p, n0, n1);
   } 
-  else {
-
+  else if constexpr (kdtree::internal::sort::keyed_payload<payload_t>) {
     kdtree::bitonic::sort(ctx, p, n0, n1);
-
+  } 
+  else {
+    kdtree::odd_even::sort(ctx, p, n0, n1);
   }
 
 }
@@ -0,0 +1,255 @@
+/*!
+ * \file        traverse/bbf.hpp
+ * \author      Samridh D. Singh
+ * \date        2025-02-01
+ * \brief       best-bin-first traversal header and implementation
+ * \details     an alternative to the stackless walk of traverse.hpp that
+ *              keeps the far subtrees it passes in a small priority queue
+ *              and always expands the closest one next.
+ *
+ * \copyright   This file is part of the sycl_kdtree project.
+ * \copyright   Copyright (C) 2025, Samridh D. Singh
+ * \copyright
+ *              sycl_kdtree is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License as
+ *              published by the Free Software Foundation, either version 3 of
+ *              the License, or (at your option) any later version.
+ *
+ *              sycl_kdtree is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *              GNU General Public License for more details.
+ *
+ *              A copy of the GNU General Public License should be provided
+ *              along with sycl_kdtree.
+ *              If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef KDTREE_TRAVERSE_BBF_HPP
+#define KDTREE_TRAVERSE_BBF_HPP
+
+#include "../pch.hpp"
+#include "../container.hpp"
+
+#include <cstddef>
+
+namespace kdtree {
+
+// takes the same policies and arguments as traverse. every subtree waits in
+// the queue with a lower bound on its squared distance to `q`, the larger
+// of its parent's bound and its splitting plane distance; the closest one is
+// expanded by descending to a leaf along the close side. at most `Q`
+// subtrees wait at once: on overflow the farthest is walked depth first on
+// the spot, so the result stays exact and only the order suffers. returns
+// false only when `budget` runs out. ctx.cell does not apply.
+template<typename result_t, typename f_process, typename f_splitdim,
+         typename F, typename T, T dim, kdtree::container::layout maj,
+         typename C_query, typename C_tree, std::size_t Q = 64>
+requires kdtree::container::container_1d<C_query>
+      && kdtree::container::container<C_tree>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+      && (Q > 0)
+constexpr bool
+traverse_bbf(result_t& result, const C_query& q, const C_tree& tree,
+             const T n, F rmax, f_splitdim splitdim = f_splitdim{},
+             const float eps = 0.0f, const std::size_t budget = 0);
+
+} // namespace kdtree
+
+///////////////////////////////////////////////////////////////////////////////
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                             IMPLEMENTATION                              ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "traverse.hpp"
+
+#include <array>
+
+namespace kdtree   {
+namespace internal {
+namespace traverse {
+
+// binary min-heap of (bound, node) pairs with room for `Q` of them.
+template <typename F, typename T, std::size_t Q>
+requires std::is_arithmetic_v<F> && std::is_integral_v<T>
+struct queue_t {
+
+  std::array<F, Q> key;
+  std::array<T, Q> node;
+  std::size_t      size{0};
+
+  constexpr bool
+  empty() const { return size == 0; }
+
+  constexpr bool
+  full() const { return size == Q; }
+
+  // moves (k, v) up from slot `i`, whose old key was not below `k`.
+  constexpr void
+  lift(std::size_t i, const F k, const T v) {
+    while (i > 0) {
+      const std::size_t p{(i - 1) / 2};
+      if (!(k < key[p])) break;
+      key[i]  = key[p];
+      node[i] = node[p];
+      i = p;
+    }
+    key[i]  = k;
+    node[i] = v;
+  }
+
+  constexpr void
+  push(const F k, const T v) { lift(size++, k, v); }
+
+  constexpr void
+  pop() {
+    --size;
+    const F k{key[size]};
+    const T v{node[size]};
+    std::size_t i{0};
+    while (1) {
+      std::size_t c{2 * i + 1};
+      if (c >= size) break;
+      if (c + 1 < size && key[c + 1] < key[c]) ++c;
+      if (!(key[c] < k)) break;
+      key[i]  = key[c];
+      node[i] = node[c];
+      i = c;
+    }
+    key[i]  = k;
+    node[i] = v;
+  }
+
+  // slot of the largest key; it is always a leaf.
+  constexpr std::size_t
+  worst() const {
+    std::size_t w{size / 2};
+    for (std::size_t i{w + 1}; i < size; ++i) {
+      if (key[w] < key[i]) w = i;
+    }
+    return w;
+  }
+
+};
+
+} // namespace traverse
+} // namespace internal
+} // namespace kdtree
+
+template<typename result_t, typename f_process, typename f_splitdim,
+         typename F, typename T, T dim, kdtree::container::layout maj,
+         typename C_query, typename C_tree, std::size_t Q>
+requires kdtree::container::container_1d<C_query>
+      && kdtree::container::container<C_tree>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+      && (Q > 0)
+constexpr bool
+kdtree::traverse_bbf(result_t& result, const C_query& q, const C_tree& tree,
+                     const T n, F rmax, f_splitdim splitdim, const float eps,
+                     const std::size_t budget) {
+
+  using kdtree::container::id;
+  using kdtree::internal::traverse::queue_t;
+
+  // see traverse for the approximate test.
+
+  using E = std::conditional_t<std::is_floating_point_v<F>, F, double>;
+
+  const E    slack  { E{1} + static_cast<E>(eps) };
+  const E    grow   { slack * slack             };
+  const bool approx { grow > E{1}               };
+
+  const auto pruned = [&](const F b) {
+    return approx ? static_cast<E>(b) * grow > static_cast<E>(rmax)
+                  : b > rmax;
+  };
+
+  if (n <= T{0}) {
+    return true;
+  }
+
+  queue_t<F, T, Q> pending;
+  pending.push(F{0}, T{0});
+
+  std::size_t visits{0};
+
+  while (!pending.empty()) {
+
+    const F bound { pending.key[0]  };
+    T       curr  { pending.node[0] };
+    pending.pop();
+
+    // everything still queued is at least as far.
+    if (pruned(bound)) {
+      break;
+    }
+
+    while (curr < n) {
+
+      if (budget != 0 && visits == budget) {
+        return false;
+      }
+      ++visits;
+      f_process{}(result, q, tree, n, curr, &rmax);
+
+      const auto s_dim       { splitdim(tree, curr)                          };
+      const auto s_pos       { id<T, dim,  maj>(tree, n,   curr, s_dim)      };
+      const auto q_pos       { id<T, dim,  maj>(q,   T{1}, T{0}, s_dim)      };
+      const F    sign_dist   { static_cast<F>(q_pos) - static_cast<F>(s_pos) };
+      const auto close_side  { sign_dist > F{0}                              };
+      const auto close_child { T{2} * curr + T{1} + close_side               };
+      const auto far_child   { T{2} * curr + T{2} - close_side               };
+
+      const F plane     { sign_dist * sign_dist         };
+      const F far_bound { plane > bound ? plane : bound };
+
+      if (far_child < n && !pruned(far_bound)) {
+        if (!pending.full()) {
+          pending.push(far_bound, far_child);
+        } else {
+          F bump{far_bound};
+          T root{far_child};
+          const std::size_t w{pending.worst()};
+          if (far_bound < pending.key[w]) {
+            bump = pending.key[w];
+            root = pending.node[w];
+            pending.lift(w, far_bound, far_child);
+          }
+          const bool done = pruned(bump)
+            || kdtree::internal::traverse::subtree<
+                 result_t, f_process, f_splitdim, F, T, dim, maj,
+                 C_query, C_tree, false
+               >(result, q, tree, n, rmax, splitdim, eps, budget, visits,
+                 root);
+          if (!done) {
+            return false;
+          }
+        }
+      }
+
+      curr = close_child;
+
+    }
+
+  }
+
+  return true;
+
+}
+
+#endif // KDTREE_TRAVERSE_BBF_HPP
@@ -0,0 +1,211 @@
+/*!
+ * \file        traverse/stack.hpp
+ * \author      Samridh D. Singh
+ * \date        2025-02-01
+ * \brief       short-stack traversal header and implementation
+ * \details     a depth-first walk like the stackless one of traverse.hpp
+ *              that remembers the far subtrees it passes instead of climbing
+ *              back through their parents.
+ *
+ * \copyright   This file is part of the sycl_kdtree project.
+ * \copyright   Copyright (C) 2025, Samridh D. Singh
+ * \copyright
+ *              sycl_kdtree is free software: you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License as
+ *              published by the Free Software Foundation, either version 3 of
+ *              the License, or (at your option) any later version.
+ *
+ *              sycl_kdtree is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *              GNU General Public License for more details.
+ *
+ *              A copy of the GNU General Public License should be provided
+ *              along with sycl_kdtree.
+ *              If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef KDTREE_TRAVERSE_STACK_HPP
+#define KDTREE_TRAVERSE_STACK_HPP
+
+#include "../pch.hpp"
+#include "../container.hpp"
+
+#include <cstddef>
+
+namespace kdtree {
+
+// takes the same policies and arguments as traverse and visits the nodes in
+// the same order. every node is read once: its far child is pushed with a
+// lower bound on its squared distance to `q`, the larger of the node's own
+// bound and its splitting plane distance, and popped entries that the bound
+// has overtaken are dropped without touching the tree. the stack keeps at
+// most one entry per level. ctx.cell does not apply.
+template<typename result_t, typename f_process, typename f_splitdim,
+         typename F, typename T, T dim, kdtree::container::layout maj,
+         typename C_query, typename C_tree>
+requires kdtree::container::container_1d<C_query>
+      && kdtree::container::container<C_tree>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+constexpr bool
+traverse_stack(result_t& result, const C_query& q, const C_tree& tree,
+               const T n, F rmax, f_splitdim splitdim = f_splitdim{},
+               const float eps = 0.0f, const std::size_t budget = 0);
+
+} // namespace kdtree
+
+namespace kdtree   {
+namespace internal {
+namespace traverse {
+
+// the walk of traverse_stack over the subtree rooted at `root` alone, with
+// `rmax` and `visits` shared with the caller as for subtree.
+template<typename result_t, typename f_process, typename f_splitdim,
+         typename F, typename T, T dim, kdtree::container::layout maj,
+         typename C_query, typename C_tree>
+requires kdtree::container::container_1d<C_query>
+      && kdtree::container::container<C_tree>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+constexpr bool
+subtree_stack(result_t& result, const C_query& q, const C_tree& tree,
+              const T n, F& rmax, f_splitdim& splitdim, const float eps,
+              const std::size_t budget, std::size_t& visits, const T root);
+
+} // namespace traverse
+} // namespace internal
+} // namespace kdtree
+
+///////////////////////////////////////////////////////////////////////////////
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                             IMPLEMENTATION                              ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///                                                                         ///
+///////////////////////////////////////////////////////////////////////////////
+
+#include <array>
+
+template<typename result_t, typename f_process, typename f_splitdim,
+         typename F, typename T, T dim, kdtree::container::layout maj,
+         typename C_query, typename C_tree>
+requires kdtree::container::container_1d<C_query>
+      && kdtree::container::container<C_tree>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+constexpr bool
+kdtree::traverse_stack(result_t& result, const C_query& q, const C_tree& tree,
+                       const T n, F rmax, f_splitdim splitdim,
+                       const float eps, const std::size_t budget) {
+
+  std::size_t visits{0};
+
+  return kdtree::internal::traverse::subtree_stack<
+    result_t, f_process, f_splitdim, F, T, dim, maj, C_query, C_tree
+  >(result, q, tree, n, rmax, splitdim, eps, budget, visits, T{0});
+
+}
+
+template<typename result_t, typename f_process, typename f_splitdim,
+         typename F, typename T, T dim, kdtree::container::layout maj,
+         typename C_query, typename C_tree>
+requires kdtree::container::container_1d<C_query>
+      && kdtree::container::container<C_tree>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+constexpr bool
+kdtree::internal::traverse::subtree_stack(result_t& result, const C_query& q,
+                                          const C_tree& tree, const T n,
+                                          F& rmax, f_splitdim& splitdim,
+                                          const float eps,
+                                          const std::size_t budget,
+                                          std::size_t& visits, const T root) {
+
+  using kdtree::container::id;
+
+  // see traverse for the approximate test.
+
+  using E = std::conditional_t<std::is_floating_point_v<F>, F, double>;
+
+  const E    slack  { E{1} + static_cast<E>(eps) };
+  const E    grow   { slack * slack             };
+  const bool approx { grow > E{1}               };
+
+  const auto pruned = [&](const F b) {
+    return approx ? static_cast<E>(b) * grow > static_cast<E>(rmax)
+                  : b > rmax;
+  };
+
+  // a tree of n nodes has bsr(n) + 1 levels, which never exceeds the bits
+  // of T.
+
+  constexpr std::size_t L { 8 * sizeof(T) };
+
+  std::array<T, L> node;
+  std::array<F, L> key;
+  std::size_t      top{0};
+
+  T curr  { root };
+  F bound { F{0} };
+
+  while (1) {
+
+    while (curr < n) {
+
+      if (budget != 0 && visits == budget) {
+        return false;
+      }
+      ++visits;
+      f_process{}(result, q, tree, n, curr, &rmax);
+
+      const auto s_dim       { splitdim(tree, curr)                          };
+      const auto s_pos       { id<T, dim,  maj>(tree, n,   curr, s_dim)      };
+      const auto q_pos       { id<T, dim,  maj>(q,   T{1}, T{0}, s_dim)      };
+      const F    sign_dist   { static_cast<F>(q_pos) - static_cast<F>(s_pos) };
+      const auto close_side  { sign_dist > F{0}                              };
+      const auto close_child { T{2} * curr + T{1} + close_side               };
+      const auto far_child   { T{2} * curr + T{2} - close_side               };
+
+      const F plane     { sign_dist * sign_dist         };
+      const F far_bound { plane > bound ? plane : bound };
+
+      if (far_child < n && !pruned(far_bound)) {
+        node[top] = far_child;
+        key[top]  = far_bound;
+        ++top;
+      }
+
+      curr = close_child;
+
+    }
+
+    do {
+      if (top == 0) {
+        return true;
+      }
+      --top;
+    } while (pruned(key[top]));
+
+    curr  = node[top];
+    bound = key[top];
+
+  }
+
+}
+
+#endif // KDTREE_TRAVERSE_STACK_HPP
@@ -31,21 +31,75 @@
 
 namespace kdtree {
 
+// `rmax` is a squared distance, like the ones f_process compares against it.
+// a far subtree is entered when its squared distance to `q` is at most `rmax`:
+// that is the distance to the splitting plane, or with `cell` the distance to
+// the subtree's cell, accumulated along the descent one axis at a time.
+// with `eps` > 0 the distance is first scaled by (1 + eps), so every point
+// left out is farther than the current bound over (1 + eps).
+// a nonzero `budget` caps the number of points handed to f_process; the walk
+// then stops early and returns false, leaving the best result found so far.
 template<typename result_t, typename f_process, typename f_splitdim, 
          typename F, typename T, T dim, kdtree::container::layout maj,
-         typename C_query, typename C_tree> 
+         typename C_query, typename C_tree, bool cell = false> 
 requires kdtree::container::container_1d<C_query> 
       && kdtree::container::container<C_tree>
       && std::is_integral_v<T>
       && std::is_arithmetic_v<F>
       && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
                         kdtree::container::get_primitive_t<C_tree>>
-constexpr void
+constexpr bool
 traverse(result_t& result, const C_query& q, const C_tree& tree, 
-         const T n, F rmax);
+         const T n, F rmax, f_splitdim splitdim = f_splitdim{},
+         const float eps = 0.0f, const std::size_t budget = 0);
 
 }
 
+namespace kdtree   {
+namespace internal {
+namespace traverse {
+
+// the walk of traverse over the subtree rooted at `root` alone. `rmax` and
+// the running count of `visits` are shared with the caller, so that other
+// engines can hand whole subtrees to it.
+template<typename result_t, typename f_process, typename f_splitdim, 
+         typename F, typename T, T dim, kdtree::container::layout maj,
+         typename C_query, typename C_tree, bool cell> 
+requires kdtree::container::container_1d<C_query> 
+      && kdtree::container::container<C_tree>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+constexpr bool
+subtree(result_t& result, const C_query& q, const C_tree& tree, const T n,
+        F& rmax, f_splitdim& splitdim, const float eps,
+        const std::size_t budget, std::size_t& visits, const T root);
+
+// traverse_bbf with ctx.walk == walker::best, traverse with ctx.cell and
+// otherwise traverse_stack, or traverse under KD__STACKLESS; all of them with
+// the slack of ctx.eps and the budget of ctx.budget. returns whether the
+// search ran to completion. searches whose partial result would be wrong
+// rather than merely approximate, like radius counts, pass `budgeted` false
+// to ignore ctx.budget.
+template<typename result_t, typename f_process, typename f_splitdim, 
+         typename F, typename T, T dim, kdtree::container::layout maj,
+         typename C_query, typename C_tree> 
+requires kdtree::container::container_1d<C_query> 
+      && kdtree::container::container<C_tree>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+constexpr bool
+run(const kdtree::query& ctx, result_t& result, const C_query& q,
+    const C_tree& tree, const T n, F rmax, f_splitdim splitdim = f_splitdim{},
+    const bool budgeted = true);
+
+} // namespace traverse
+} // namespace internal
+} // namespace kdtree
+
 ///////////////////////////////////////////////////////////////////////////////
 ///                                                                         ///
 ///                                                                         ///
@@ -79,11 +133,33 @@ struct f_splitdim {
 
 };
 
+// split dimensions recorded per node by an adaptive create.
+template <typename T, T dim, kdtree::container::layout maj, typename C,
+          typename C_dim>
+requires kdtree::container::container<C> && std::integral<T>
+      && kdtree::container::container_1d<C_dim>
+struct f_splitdim_table {
+
+  const C_dim& dims;
+
+  constexpr inline T
+  operator()(const C& v, const T s) const {
+    (void) v;
+    return static_cast<T>(kdtree::container::id<T>(dims, T{0}, s));
+  }
+
+};
+
 } // namespace traverse
 } // namespace internal
 } // namespace kdtree
 
 #include "../internal/abs.hpp"
+#include "bbf.hpp"
+#include "stack.hpp"
+
+#include <array>
+#include <cstddef>
 
 #if 0
 
@@ -154,22 +230,78 @@ kdtree::traverse(result_t& result, const C_query& q, const C_tree& tree,
 
 template<typename result_t, typename f_process, typename f_splitdim, 
          typename F, typename T, T dim, kdtree::container::layout maj,
-         typename C_query, typename C_tree> 
+         typename C_query, typename C_tree, bool cell> 
 requires kdtree::container::container_1d<C_query> 
       && kdtree::container::container<C_tree>
       && std::is_integral_v<T>
       && std::is_arithmetic_v<F>
       && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
                         kdtree::container::get_primitive_t<C_tree>>
-constexpr void
+constexpr bool
 kdtree::traverse(result_t& result, const C_query& q, const C_tree& tree, 
-                 const T n, F rmax) {
+                 const T n, F rmax, f_splitdim splitdim, const float eps,
+                 const std::size_t budget) {
+
+  std::size_t visits{0};
+
+  return kdtree::internal::traverse::subtree<
+    result_t, f_process, f_splitdim, F, T, dim, maj, C_query, C_tree, cell
+  >(result, q, tree, n, rmax, splitdim, eps, budget, visits, T{0});
 
-  T curr { 0 };
-  T prev { static_cast<T>(-1) };
+}
+
+template<typename result_t, typename f_process, typename f_splitdim, 
+         typename F, typename T, T dim, kdtree::container::layout maj,
+         typename C_query, typename C_tree, bool cell> 
+requires kdtree::container::container_1d<C_query> 
+      && kdtree::container::container<C_tree>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+constexpr bool
+kdtree::internal::traverse::subtree(result_t& result, const C_query& q,
+                                    const C_tree& tree, const T n, F& rmax,
+                                    f_splitdim& splitdim, const float eps,
+                                    const std::size_t budget,
+                                    std::size_t& visits, const T root) {
+
+  // the walk ends when it climbs back to the parent of `root`; for the root
+  // of the tree that is -1.
+
+  const T top { (root + T{1}) / T{2} - T{1} };
+
+  T curr { root };
+  T prev { top  };
+
+  if (root >= n) {
+    return true;
+  }
 
   using kdtree::container::id;
-  using kdtree::internal::abs;
+  using kdtree::internal::bsr;
+
+  // the approximate test runs in floating point whatever F is; exact queries
+  // keep comparing in F.
+
+  using E = std::conditional_t<std::is_floating_point_v<F>, F, double>;
+
+  const E    slack  { E{1} + static_cast<E>(eps) };
+  const E    grow   { slack * slack             };
+  const bool approx { grow > E{1}               };
+
+  // with `cell`, off[e] is the signed offset of `q` from the current cell
+  // along axis e and `bound` the sum of their squares. entering a far child
+  // moves one offset onto its splitting plane; the values it replaced are
+  // saved per level and put back on the way up.
+
+  constexpr std::size_t D { cell ? static_cast<std::size_t>(dim) : 0 };
+  constexpr std::size_t L { cell ? 8 * sizeof(T)                 : 0 };
+
+  [[maybe_unused]] std::array<F, D> off       {};
+  [[maybe_unused]] std::array<F, L> off_saved {};
+  [[maybe_unused]] std::array<F, L> bnd_saved {};
+  [[maybe_unused]] F                bound     {0};
 
   while (1) {
 
@@ -183,17 +315,33 @@ kdtree::traverse(result_t& result, const C_query& q, const C_tree& tree,
     }
 
     if (from_parent) {
+      if (budget != 0 && visits == budget) {
+        return false;
+      }
+      ++visits;
       f_process{}(result, q, tree, n, curr, &rmax);
     }
 
-    const auto s_dim        { f_splitdim{}(tree, curr)                 };
-    const auto s_pos        { id<T, dim,  maj>(tree, n,   curr, s_dim) };
-    const auto q_pos        { id<T, T{1}, maj>(q,    dim, T{0}, s_dim) };
-    const auto sign_dist    { static_cast<F>(q_pos - s_pos)            };
-    const auto close_side   { sign_dist > F{0}                         };
-    const auto close_child  { T{2} * curr + T{1} + close_side          };
-    const auto far_child    { T{2} * curr + T{2} - close_side          };
-    const auto far_in_range { abs(sign_dist) <= rmax                   };
+    // the difference is taken in F so that unsigned coordinates cannot wrap.
+
+    const auto s_dim       { splitdim(tree, curr)                          };
+    const auto s_pos       { id<T, dim,  maj>(tree, n,   curr, s_dim)      };
+    const auto q_pos       { id<T, dim,  maj>(q,   T{1}, T{0}, s_dim)      };
+    const F    sign_dist   { static_cast<F>(q_pos) - static_cast<F>(s_pos) };
+    const auto close_side  { sign_dist > F{0}                              };
+    const auto close_child { T{2} * curr + T{1} + close_side               };
+    const auto far_child   { T{2} * curr + T{2} - close_side               };
+
+    F far_bound { sign_dist * sign_dist };
+    if constexpr (cell) {
+      const F o { off[static_cast<std::size_t>(s_dim)] };
+      far_bound += bound - o * o;
+    }
+
+    const bool far_in_range {
+      approx ? static_cast<E>(far_bound) * grow <= static_cast<E>(rmax)
+             : far_bound <= rmax
+    };
 
     T next;
     if (from_parent) {
@@ -204,8 +352,22 @@ kdtree::traverse(result_t& result, const C_query& q, const C_tree& tree,
       next = parent;
     }
 
-    if (next == static_cast<T>(-1)) {
-      return;
+    if constexpr (cell) {
+      const auto l { static_cast<std::size_t>(bsr(curr + 1)) };
+      const auto d { static_cast<std::size_t>(s_dim)         };
+      if (!from_parent && next == far_child) {
+        off_saved[l] = off[d];
+        bnd_saved[l] = bound;
+        off[d]       = sign_dist;
+        bound        = far_bound;
+      } else if (!from_parent && prev == far_child) {
+        off[d]       = off_saved[l];
+        bound        = bnd_saved[l];
+      }
+    }
+
+    if (next == top) {
+      return true;
     }
 
     prev = curr;
@@ -217,4 +379,47 @@ kdtree::traverse(result_t& result, const C_query& q, const C_tree& tree,
 
 #endif
 
+template<typename result_t, typename f_process, typename f_splitdim, 
+         typename F, typename T, T dim, kdtree::container::layout maj,
+         typename C_query, typename C_tree> 
+requires kdtree::container::container_1d<C_query> 
+      && kdtree::container::container<C_tree>
+      && std::is_integral_v<T>
+      && std::is_arithmetic_v<F>
+      && std::is_same_v<kdtree::container::get_primitive_t<C_query>,
+                        kdtree::container::get_primitive_t<C_tree>>
+constexpr bool
+kdtree::internal::traverse::run(const kdtree::query& ctx, result_t& result,
+                                const C_query& q, const C_tree& tree,
+                                const T n, F rmax, f_splitdim splitdim,
+                                const bool budgeted) {
+
+  const std::size_t budget{budgeted ? ctx.budget : 0};
+
+  if (ctx.walk == kdtree::walker::best) {
+    return kdtree::traverse_bbf<result_t, f_process, f_splitdim, F, T, dim,
+                                maj, C_query, C_tree>(result, q, tree, n,
+                                                      rmax, splitdim,
+                                                      ctx.eps, budget);
+  }
+  if (ctx.cell) {
+    return kdtree::traverse<result_t, f_process, f_splitdim, F, T, dim, maj,
+                            C_query, C_tree, true>(result, q, tree, n, rmax,
+                                                   splitdim, ctx.eps,
+                                                   budget);
+  }
+#ifdef KD__STACKLESS
+  return kdtree::traverse<result_t, f_process, f_splitdim, F, T, dim, maj,
+                          C_query, C_tree, false>(result, q, tree, n, rmax,
+                                                  splitdim, ctx.eps,
+                                                  budget);
+#else
+  return kdtree::traverse_stack<result_t, f_process, f_splitdim, F, T, dim,
+                                maj, C_query, C_tree>(result, q, tree, n,
+                                                      rmax, splitdim,
+                                                      ctx.eps, budget);
+#endif
+
+}
+
 #endif  // KDTREE_TRAVERSE_HPP
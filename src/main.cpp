@@ -5,7 +5,6 @@
 #include <fstream>
 
 #include <kdtree.hpp>
-#include <omp.h>
 
 volatile int sink = 0;
 
@@ -135,17 +134,11 @@ main(void) {
   {
 
     std::vector<type_s>    vidx(n, 0);
+    std::vector<float>     vdst(n, 0);
 
     auto beg{std::chrono::high_resolution_clock::now()};
-    #pragma omp parallel for
-    for (type_s i = 0; i < n; ++i) {
-
-      for (type_s j = 0; j < dim; ++j) {
-        q[j] = kdtree::container::id<type_s, dim, maj>(vec, n, i, j);
-      }
-
-      vidx[i] = kdtree::nn<float, type_s, dim, maj>(ctx, q, vec, n, rmax);
-    }
+    kdtree::nn_batch<float, type_s, dim, maj>(ctx, vec, n, vec, n, 
+                                              vidx, vdst, rmax);
 
       for (type_s j = 0; j < dim; ++j) {
         std::cout << kdtree::container::id<type_s, dim, maj>(vec, n, 4, j) << " ";
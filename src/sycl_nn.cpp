@@ -123,6 +123,9 @@ main(void) {
   queue.memcpy(usm__vidx, vidx.data(),  n    * sizeof(T_s));
   queue.memcpy(usm__vec,  vec.data(),   dim*n* sizeof(T_v));
 
+  // kernels take the query fields only; the context owns the host pool.
+  const kdtree::query qctx{ctx};
+
   auto beg { std::chrono::high_resolution_clock::now() };
 
   queue.parallel_for(sycl::nd_range<1>(global_size, block_size), 
@@ -134,12 +137,9 @@ main(void) {
       return; 
     }
 
-    T_v q[dim];
-    for (T_s j{0}; j < dim; ++j) {
-      q[j] = kdtree::container::id<T_s, dim, maj>(usm__vec, n, i, j);
-    }
-
-    usm__vidx[i] = kdtree::nn<float, T_s, dim, maj>(ctx, q, usm__vec, n);
+    // every query is a point of the tree: start where it lives.
+    usm__vidx[i] = kdtree::self_knn<1, float, T_s, dim, maj>(
+      qctx, usm__vec, n, static_cast<T_s>(i))[0];
 
   });
 
@@ -148,10 +148,10 @@ main(void) {
   auto end {std::chrono::high_resolution_clock::now()};
   auto dur {std::chrono::duration_cast<std::chrono::milliseconds>(end - beg)};
 
-  std::cout << "[kdtree::nn][time]:\t" 
+  std::cout << "[kdtree::self_knn][time]:\t" 
             << dur.count() << " ms\n";
 
-  std::cout << "[kdtree::nn][throughput]:\t" 
+  std::cout << "[kdtree::self_knn][throughput]:\t" 
             << static_cast<int>((n / (dur.count() * 1e-3) * 1e-6)) << "M\n";
 
   queue.memcpy(vidx.data(), usm__vidx, n * sizeof(T_s)).wait();
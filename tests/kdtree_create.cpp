@@ -97,6 +97,72 @@ TEST_CASE("[basic_example] kdtree::create") {
     CHECK(vec == ans);
   }
 
+  SUBCASE("[type=[]][maj=row][keys]") {
+    std::vector<Tv> vec = {
+      10, 15, 46, 63, 68, 21, 40, 33, 25, 54,
+      15, 43, 44, 58, 45, 40, 62, 69, 53, 67,
+    };
+
+    std::vector<Tv> ans = {
+      46, 63, 15, 43, 53, 67, 40, 33, 44, 58,
+      68, 21, 62, 69, 10, 15, 45, 40, 25, 54,
+    };
+
+    kdtree::context ctx_keys;
+    ctx_keys.keys = true;
+    kdtree::create<Ts, dim, kdtree::container::layout::row_major>(ctx_keys,
+                                                                  vec, n);
+
+    INFO(log_vec(vec));
+    INFO(log_vec(ans));
+
+    CHECK(vec == ans);
+  }
+
+  SUBCASE("[type=[]][maj=row][select]") {
+    std::vector<Tv> vec = {
+      10, 15, 46, 63, 68, 21, 40, 33, 25, 54,
+      15, 43, 44, 58, 45, 40, 62, 69, 53, 67,
+    };
+
+    std::vector<Tv> ans = {
+      46, 63, 15, 43, 53, 67, 40, 33, 44, 58,
+      68, 21, 62, 69, 10, 15, 45, 40, 25, 54,
+    };
+
+    kdtree::context ctx_select;
+    ctx_select.build = kdtree::builder::select;
+    kdtree::create<Ts, dim, kdtree::container::layout::row_major>(ctx_select,
+                                                                  vec, n);
+
+    INFO(log_vec(vec));
+    INFO(log_vec(ans));
+
+    CHECK(vec == ans);
+  }
+
+  SUBCASE("[type=[]][maj=row][presort]") {
+    std::vector<Tv> vec = {
+      10, 15, 46, 63, 68, 21, 40, 33, 25, 54,
+      15, 43, 44, 58, 45, 40, 62, 69, 53, 67,
+    };
+
+    std::vector<Tv> ans = {
+      46, 63, 15, 43, 53, 67, 40, 33, 44, 58,
+      68, 21, 62, 69, 10, 15, 45, 40, 25, 54,
+    };
+
+    kdtree::context ctx_presort;
+    ctx_presort.build = kdtree::builder::presort;
+    kdtree::create<Ts, dim, kdtree::container::layout::row_major>(ctx_presort,
+                                                                   vec, n);
+
+    INFO(log_vec(vec));
+    INFO(log_vec(ans));
+
+    CHECK(vec == ans);
+  }
+
   SUBCASE("[type=[]][maj=col]") {
 
     std::vector<Tv> vec = {
@@ -215,15 +281,16 @@ none_below(const C &src, const T n, const T i, const T d, const Tv &v) {
 template <typename T, T dim, kdtree::container::layout maj, typename C,
           typename Tv = typename C::value_type>
 bool
-verify_subtree(const C &src, const T n, const T i = T(0)) {
+verify_subtree(const C &src, const T n, const T i = T(0),
+               const std::uint8_t* dims = nullptr) {
   if (i >= n) return true;
   T l {level_of(i)};
-  T d {l % dim};
+  T d {dims ? static_cast<T>(dims[i]) : l % dim};
   Tv v{kdtree::container::id<T, dim, maj>(src, n, i, d)};
   if (!none_above<T, dim, maj>(src, n,  2 * i + 1, d, v)) return false;
   if (!none_below<T, dim, maj>(src, n,  2 * i + 2, d, v)) return false;
-  return verify_subtree<T, dim, maj>(src, n,  2 * i + 1)
-      && verify_subtree<T, dim, maj>(src, n,  2 * i + 2);
+  return verify_subtree<T, dim, maj>(src, n,  2 * i + 1, dims)
+      && verify_subtree<T, dim, maj>(src, n,  2 * i + 2, dims);
 }
 
 } // namespace internal
@@ -232,9 +299,9 @@ template <typename T, T dim,
           kdtree::container::layout maj = kdtree::container::layout::row_major,
           typename C>
 bool 
-verify_kdtree(const C &src) {
+verify_kdtree(const C &src, const std::uint8_t* dims = nullptr) {
   const T n{static_cast<T>(src.size()) / dim};
-  return internal::verify_subtree<T, dim, maj>(src, n);
+  return internal::verify_subtree<T, dim, maj>(src, n, T(0), dims);
 }
 
 #include <random>
@@ -249,13 +316,14 @@ generate_random_dataset(C& src, T xmin, T xmax) {
 
 template <typename T, std::size_t dim>
 static void 
-test(const std::string& tag, std::size_t N, int xlim[2]) {
+test(const std::string& tag, std::size_t N, int xlim[2],
+     const kdtree::context& ctx_ = kdtree::context{}) {
 
   if (N <= 0) {
     return;
   }
 
-  kdtree::context ctx;
+  kdtree::context ctx{ctx_};
 
   SUBCASE(("[N=" + std::to_string(N) + "]" + tag).c_str()) {
     
@@ -332,6 +400,35 @@ TEST_CASE("[case=" #index "] kdtree::create") { \
   for (size_t i{0}; i <= N_MAX; ++i) nvec.push_back(i); \
   nvec.insert(nvec.end(), {64, 256, 512}); \
   for (auto n : nvec) test<type, dim>("[type_dim]", n, xlim); \
+  kdtree::context ctx_keys; \
+  ctx_keys.keys = true; \
+  for (auto n : nvec) test<type, dim>("[keys]", n, xlim, ctx_keys); \
+  kdtree::context ctx_radix; \
+  ctx_radix.sort = kdtree::sorter::radix; \
+  for (auto n : nvec) test<type, dim>("[radix]", n, xlim, ctx_radix); \
+  kdtree::context ctx_select; \
+  ctx_select.build = kdtree::builder::select; \
+  for (auto n : nvec) test<type, dim>("[select]", n, xlim, ctx_select); \
+  ctx_select.keys = true; \
+  for (auto n : nvec) test<type, dim>("[select][keys]", n, xlim, ctx_select); \
+  kdtree::context ctx_local; \
+  ctx_local.local = 0; \
+  for (auto n : nvec) test<type, dim>("[local=0]", n, xlim, ctx_local); \
+  ctx_local.local = 8; \
+  for (auto n : nvec) test<type, dim>("[local=8]", n, xlim, ctx_local); \
+  ctx_local.keys = true; \
+  for (auto n : nvec) test<type, dim>("[local=8][keys]", n, xlim, ctx_local); \
+  ctx_local.fuse = false; \
+  for (auto n : nvec) test<type, dim>("[unfused]", n, xlim, ctx_local); \
+  kdtree::context ctx_pre; \
+  ctx_pre.build = kdtree::builder::presort; \
+  for (auto n : nvec) test<type, dim>("[presort]", n, xlim, ctx_pre); \
+  ctx_pre.sort = kdtree::sorter::radix; \
+  for (auto n : nvec) test<type, dim>("[presort][radix]", n, xlim, ctx_pre); \
+  kdtree::context ctx_merge; \
+  ctx_merge.sort = kdtree::sorter::merge; \
+  ctx_merge.local = 0; \
+  for (auto n : nvec) test<type, dim>("[merge]", n, xlim, ctx_merge); \
 }
 
 TEST_CREATE(1,  uint16_t, 1)
@@ -346,4 +443,78 @@ TEST_CREATE(9,  float,    9)
 TEST_CREATE(10, double,   3)
 TEST_CREATE(11, double,   7)
 
+TEST_CASE("[threads] kdtree::create") {
+
+  using Ts = uint32_t;
+  constexpr Ts dim{3};
+  constexpr auto maj{kdtree::container::layout::row_major};
+
+  for (std::size_t nthreads : {1, 2, 3, 8}) {
+    for (std::size_t N : {1000, 4096, 5000, 100000}) {
+      kdtree::context ctx(nthreads);
+      ctx.keys = (N % 2 == 0);
+      ctx.sort = (N == 5000)   ? kdtree::sorter::radix 
+               : (N == 100000) ? kdtree::sorter::sample 
+               : (N == 1000)   ? kdtree::sorter::merge 
+                               : kdtree::sorter::bitonic;
+      ctx.build = (nthreads == 8) ? kdtree::builder::presort
+                : (nthreads % 2 == 0) ? kdtree::builder::select 
+                                      : kdtree::builder::sort;
+      ctx.local = (nthreads == 3) ? 0 : std::size_t{1} << (N % 7 + 6);
+      ctx.fuse = (N != 4096);
+      std::vector<int> vec(N * dim);
+      generate_random_dataset(vec, -1024, 1024);
+      CAPTURE(nthreads);
+      CAPTURE(N);
+      kdtree::create<Ts, dim, maj>(ctx, vec, N);
+      CHECK(verify_kdtree<Ts, dim, maj>(vec));
+    }
+  }
+
+}
+
+TEST_CASE("[adaptive] kdtree::create") {
+
+  using Ts = uint32_t;
+  constexpr Ts dim{3};
+  constexpr auto maj{kdtree::container::layout::row_major};
+
+  // a thin slab: x spans 64x the range of y, and z is nearly flat.
+
+  const auto slab = [](std::vector<int>& vec) {
+    std::vector<int> x(vec.size() / dim);
+    for (int e : {0, 1, 2}) {
+      const int w{e == 0 ? 1 << 16 : e == 1 ? 1 << 10 : 4};
+      generate_random_dataset(x, -w, w);
+      for (std::size_t i{0}; i < x.size(); ++i) vec[i * dim + e] = x[i];
+    }
+  };
+
+  for (int mode : {0, 1, 2, 3, 4}) {
+    for (std::size_t N : {1, 2, 7, 100, 4096, 5000, 100000}) {
+      kdtree::context ctx;
+      ctx.keys  = (mode == 1);
+      ctx.build = (mode == 2) ? kdtree::builder::select
+                : (mode == 3) ? kdtree::builder::presort
+                              : kdtree::builder::sort;
+      ctx.local = (mode == 4) ? 0 : std::size_t{1} << 10;
+      std::vector<int> vec(N * dim);
+      slab(vec);
+      std::vector<std::uint8_t> dims;
+      CAPTURE(mode);
+      CAPTURE(N);
+      kdtree::create<Ts, dim, maj>(ctx, vec, N, dims);
+      REQUIRE(dims.size() == N);
+      CHECK(verify_kdtree<Ts, dim, maj>(vec, dims.data()));
+      if (N >= 100) {
+        CHECK(dims[0] == 0);
+        std::size_t nz{0};
+        for (std::size_t c{0}; c < N / 2; ++c) nz += (dims[c] == 2);
+        CHECK(nz < N / 16);
+      }
+    }
+  }
+
+}
+
 #endif // USE_LARGE_TEST
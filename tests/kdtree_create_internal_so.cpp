@@ -0,0 +1,96 @@
+/*
+ * Filename: tests/kdtree_create_internal_so.cpp
+ * Author:   Samridh D. Singh
+ * Date:     2025-02-01
+ *
+ * This file is part of sycl_kdtree.
+ *
+ * sycl_kdtree is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * sycl_kdtree is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with sycl_kdtree. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pch.h"
+
+#include <create/internal/so.hpp>
+#include <create/internal/ss.hpp>
+#include <internal/bsr.hpp>
+
+using kdtree::internal::create::so;
+using kdtree::internal::bsr;
+
+template <typename T>
+requires std::is_integral_v<T>
+constexpr inline T
+so(const T s, const T n) {
+  const T L{bsr(n)+1};
+  return so(s, n, L);
+}
+
+namespace ref {
+
+template <typename T>
+requires std::is_integral_v<T>
+constexpr inline T
+ss(const T s, const T n) {
+  if (s >= n) return T{0};
+  return T{1} + ss(T{2} * s + T{1}, n) + ss(T{2} * s + T{2}, n);
+}
+
+// walks down from the root: going right skips the left subtree and the node.
+template <typename T>
+requires std::is_integral_v<T>
+constexpr inline T
+so(const T s, const T n) {
+  const T l{bsr(s+1)};
+  T so_s{0};
+  T c{0};
+  for (T i{l}; i > 0; --i) {
+    if (((s + 1) >> (i - 1)) & T{1}) {
+      so_s += ss(T{2} * c + T{1}, n) + T{1};
+      c = T{2} * c + T{2};
+    } else {
+      c = T{2} * c + T{1};
+    }
+  }
+  return so_s;
+}
+
+} // namespace ref
+
+template <typename T>
+static void
+check(const T nmax) {
+  for (T n{1}; n < nmax; ++n) {
+    for (T s{0}; s < n; ++s) {
+      CAPTURE(n);
+      CAPTURE(s);
+      CHECK_EQ(so(s, n), ref::so(s, n));
+    }
+  }
+}
+
+TEST_CASE("[case=1][std::int32_t]")  { check<std::int32_t>(257);  }
+TEST_CASE("[case=2][std::uint32_t]") { check<std::uint32_t>(257); }
+TEST_CASE("[case=3][std::uint64_t]") { check<std::uint64_t>(257); }
+
+TEST_CASE("[case=4]") {
+
+  using T = std::uint32_t;
+
+  CHECK_EQ(so<T>(0, 1),  T{0});
+  CHECK_EQ(so<T>(0, 10), T{0});
+  CHECK_EQ(so<T>(1, 10), T{0});
+  CHECK_EQ(so<T>(2, 10), T{7});
+  CHECK_EQ(so<T>(4, 10), T{4});
+
+}
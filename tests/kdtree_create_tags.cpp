@@ -0,0 +1,76 @@
+/*
+ * Filename: tests/kdtree_create_tags.cpp
+ * Author:   Samridh D. Singh
+ * Date:     2025-02-01
+ *
+ * This file is part of sycl_kdtree.
+ *
+ * sycl_kdtree is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * sycl_kdtree is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with sycl_kdtree. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pch.h"
+
+#include <create/tags.hpp>
+#include <create/internal/F.hpp>
+#include <create/internal/so.hpp>
+#include <create/internal/ss.hpp>
+#include <internal/bsr.hpp>
+
+using kdtree::internal::create::F;
+using kdtree::internal::create::so;
+using kdtree::internal::create::ss;
+using kdtree::internal::bsr;
+
+// after the last level every slot must hold the node it ends up in, which
+// for the in-place layout is the node whose pivot sits at that offset.
+template <typename T>
+static std::vector<T>
+expected(const T n) {
+  const T L{bsr(n)+1};
+  std::vector<T> ans(n);
+  for (T c{0}; c < n; ++c) ans[so(c, n, L) + ss(T{2} * c + T{1}, n, L)] = c;
+  return ans;
+}
+
+TEST_CASE("[update] kdtree::internal::create::tags") {
+
+  using T = uint32_t;
+
+  for (std::size_t nthreads : {1, 3}) {
+    kdtree::context ctx(nthreads);
+    for (T n{1}; n < 600; n += (n < 70 ? 1 : 37)) {
+
+      CAPTURE(nthreads);
+      CAPTURE(n);
+
+      const T L{bsr(n)+1};
+      std::vector<T> level(n, 0);
+      std::vector<T> fused(n, 0);
+
+      for (T l{0}; l < L; ++l) {
+        kdtree::internal::create::tags::update(ctx, level, n, l);
+        for (T c{F(l)}; c < n && c < F(l + 1); ++c) {
+          const T n0{so(c, n, L)};
+          kdtree::internal::create::tags::update(fused, n, c, n0, 
+                                                 n0 + ss(c, n, L));
+        }
+        REQUIRE(level == fused);
+      }
+
+      CHECK(level == expected(n));
+
+    }
+  }
+
+}
@@ -0,0 +1,77 @@
+/*
+ * Filename: kdtree_internal_key.cpp
+ * Author:   Samridh D. Singh
+ * Date:     2025-02-01
+ *
+ * This file is part of sycl_kdtree.
+ *
+ * sycl_kdtree is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * sycl_kdtree is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with sycl_kdtree. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pch.h"
+#include "internal/key.hpp"
+
+using kdtree::internal::key::encode;
+
+template <typename V>
+static void
+check(std::vector<V> v) {
+  std::sort(v.begin(), v.end());
+  for (std::size_t i{1}; i < v.size(); ++i) {
+    CAPTURE(v[i-1]);
+    CAPTURE(v[i]);
+    if (v[i-1] < v[i]) CHECK(encode(v[i-1]) < encode(v[i]));
+    else               CHECK(encode(v[i-1]) == encode(v[i]));
+  }
+}
+
+TEST_CASE("[key][type=int]") {
+  using L = std::numeric_limits<int32_t>;
+  check<int32_t>({ L::min(), L::min() + 1, -5, -1, 0, 0, 1, 7, L::max() });
+  check<int16_t>({ -32768, -300, -1, 0, 1, 300, 32767 });
+  check<int64_t>({ std::numeric_limits<int64_t>::min(), -1, 0, 1,
+                   std::numeric_limits<int64_t>::max() });
+}
+
+TEST_CASE("[key][type=unsigned]") {
+  check<uint16_t>({ 0, 1, 2, 65535 });
+  check<uint32_t>({ 0, 1, 2, 0xffffffffu });
+  check<uint64_t>({ 0, 1, 2, ~uint64_t{0} });
+}
+
+TEST_CASE("[key][type=float]") {
+  using L = std::numeric_limits<float>;
+  check<float>({ -L::infinity(), L::lowest(), -1e10f, -1.5f, -1.0f,
+                 -L::denorm_min(), 0.0f, L::denorm_min(), L::min(), 0.25f,
+                 1.0f, 3e20f, L::max(), L::infinity() });
+}
+
+TEST_CASE("[key][type=double]") {
+  using L = std::numeric_limits<double>;
+  check<double>({ -L::infinity(), L::lowest(), -1e300, -2.0, -L::min(), 0.0,
+                  L::min(), 1e-300, 2.0, L::max(), L::infinity() });
+}
+
+TEST_CASE("[key][random]") {
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> fdist(-1e6f, 1e6f);
+  std::uniform_int_distribution<int32_t> idist(std::numeric_limits<int32_t>::min(),
+                                               std::numeric_limits<int32_t>::max());
+  std::vector<float>   vf(4096);
+  std::vector<int32_t> vi(4096);
+  for (auto& v : vf) v = fdist(rng);
+  for (auto& v : vi) v = idist(rng);
+  check(vf);
+  check(vi);
+}
@@ -0,0 +1,104 @@
+/*
+ * Filename: kdtree_internal_pool.cpp
+ * Author:   Samridh D. Singh
+ * Date:     2025-02-01
+ *
+ * This file is part of sycl_kdtree.
+ *
+ * sycl_kdtree is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * sycl_kdtree is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with sycl_kdtree. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pch.h"
+#include <pch.hpp>
+
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+
+using kdtree::internal::pool;
+
+static long
+fib(pool& p, const int k) {
+  if (k < 2) return k;
+  long a{0}, b{0};
+  if (k > 12) {
+    p.invoke([&] { a = fib(p, k - 1); }, [&] { b = fib(p, k - 2); });
+  } else {
+    a = fib(p, k - 1);
+    b = fib(p, k - 2);
+  }
+  return a + b;
+}
+
+TEST_CASE("[pool] size") {
+  CHECK(pool(0).size() == 1);
+  CHECK(pool(1).size() == 1);
+  CHECK(pool(4).size() == 4);
+  CHECK(kdtree::context(3).pool().size() == 3);
+  CHECK(kdtree::context(0).pool().size() == 1);
+}
+
+TEST_CASE("[pool] context starts its pool on first use") {
+  kdtree::context ctx(2);
+  CHECK(ctx.nthreads == 2);
+  ctx.nthreads = 5;
+  kdtree::context copy{ctx};
+  CHECK(ctx.pool().size() == 5);
+  copy.nthreads = 1;
+  CHECK(&copy.pool() == &ctx.pool());
+  CHECK(copy.pool().size() == 5);
+}
+
+TEST_CASE("[pool] parallel_for visits every index once") {
+  for (std::size_t nt : {1, 2, 4, 7}) {
+    pool p(nt);
+    for (int n : {0, 1, 5, 1000, 12345}) {
+      for (int grain : {1, 7, 64, 100000}) {
+        std::vector<std::atomic<int>> seen(static_cast<std::size_t>(n));
+        p.parallel_for(0, n, grain, [&](int i0, int i1) {
+          if (nt > 1) CHECK(i1 - i0 <= grain);
+          for (int i = i0; i < i1; ++i) ++seen[static_cast<std::size_t>(i)];
+        });
+        for (auto& s : seen) REQUIRE(s.load() == 1);
+      }
+    }
+  }
+}
+
+TEST_CASE("[pool] nested fork-join") {
+  for (std::size_t nt : {1, 2, 4, 8}) {
+    pool p(nt);
+    CHECK(fib(p, 24) == 46368);
+
+    std::atomic<long> sum{0};
+    p.parallel_for(0, 64, 1, [&](int i0, int i1) {
+      for (int i = i0; i < i1; ++i) {
+        p.parallel_for(0, 100, 3, [&](int j0, int j1) {
+          for (int j = j0; j < j1; ++j) sum += j;
+        });
+      }
+    });
+    CHECK(sum.load() == 64 * 4950);
+  }
+}
+
+TEST_CASE("[pool] exceptions reach the caller") {
+  pool p(4);
+  CHECK_THROWS_AS(p.parallel_for(0, 1000, 1, [](int i0, int) {
+    if (i0 == 500) throw std::runtime_error("boom");
+  }), std::runtime_error);
+  CHECK_THROWS_AS(p.invoke([] {}, [] { throw std::logic_error("b"); }),
+                  std::logic_error);
+  CHECK(fib(p, 20) == 6765);
+}
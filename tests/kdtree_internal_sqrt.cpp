@@ -0,0 +1,43 @@
+/*
+ * Filename: kdtree_internal_sqrt.cpp
+ * Author:   Samridh D. Singh
+ * Date:     2025-02-01
+ *
+ * This file is part of sycl_kdtree.
+ *
+ * sycl_kdtree is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * sycl_kdtree is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with sycl_kdtree. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pch.h"
+#include "internal/sqrt.hpp"
+
+namespace ki = kdtree::internal;
+
+TEST_CASE("[sqrt][type=float]") {
+  CHECK(ki::sqrt(  4.0f) == doctest::Approx(2.0f));
+  CHECK(ki::sqrt(  2.0f) == doctest::Approx(1.41421356f));
+  CHECK(ki::sqrt(  0.0f) == doctest::Approx(0.0f));
+}
+
+TEST_CASE("[sqrt][type=double]") {
+  CHECK(ki::sqrt( 9.0)   == doctest::Approx(3.0));
+  CHECK(ki::sqrt( 1e-6)  == doctest::Approx(1e-3));
+}
+
+TEST_CASE("[sqrt][type=int]") {
+  CHECK(ki::sqrt(  0) == 0);
+  CHECK(ki::sqrt( 16) == 4);
+  CHECK(ki::sqrt( 17) == 4);
+  CHECK(ki::sqrt(uint64_t{1} << 40) == uint64_t{1} << 20);
+}
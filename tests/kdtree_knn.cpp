@@ -21,6 +21,9 @@
 #include "pch.h"
 
 #include <knn/knn.hpp>
+#include <knn/batch.hpp>
+#include <knn/self.hpp>
+#include <knn/graph.hpp>
 #include <create/create.hpp>
 
 #include <random>
@@ -197,7 +200,7 @@ test_knn_impl(void) {
   std::vector<type_v> vec(dim * n);
 
   generate_random_dataset(vec);
-  kdtree::create<type_s, dim>(ctx, vec, n);
+  kdtree::create<type_s, dim, maj>(ctx, vec, n);
 
   std::string layout = (maj == kdtree::container::layout::row_major)
                      ? "row_major"
@@ -245,3 +248,923 @@ TEST_CASE("[random] kdtree::knn multiple k values") {
   test_knn_impl<6, kdtree::container::layout::col_major, 1 << 14>();
 }
 
+
+TEST_CASE("[adaptive] kdtree::knn") {
+
+  using type_v = int;
+  using type_s = std::size_t;
+  constexpr type_s dim{3};
+  constexpr auto   maj{kdtree::container::layout::row_major};
+
+  for (type_s n : {1, 2, 9, 1000, 5000}) {
+
+    kdtree::context ctx;
+    std::vector<type_v> vec(dim * n);
+    generate_random_dataset(vec);
+    for (type_s i{0}; i < n; ++i) {
+      vec[i * dim + 1] /= 1 << 6;
+      vec[i * dim + 2] /= 1 << 12;
+    }
+
+    std::vector<std::uint8_t> dims;
+    kdtree::create<type_s, dim, maj>(ctx, vec, n, dims);
+
+    const type_s k{std::min<type_s>(8, n)};
+
+    for (int i{0}; i < 16; ++i) {
+      std::vector<type_v> q(dim);
+      generate_random_dataset(q);
+      q[1] /= 1 << 6;
+      q[2] /= 1 << 12;
+      CAPTURE(n);
+      const auto idx = kdtree::knn<double, type_s, dim, maj>(ctx, q, vec,
+                                                             n, dims, k);
+      const auto ans = ref::knn<double, type_s, dim, maj>(ctx, q, vec, n, k);
+      CHECK(idx == ans);
+    }
+
+    constexpr type_s m{64};
+    std::vector<type_v> qs(dim * m);
+    generate_random_dataset(qs);
+    std::vector<type_s> b_idx(m * k);
+    std::vector<double> b_dst(m * k);
+    kdtree::knn_batch<double, type_s, dim, maj>(ctx, qs, m, vec, n, dims, k,
+                                                b_idx, b_dst);
+    for (type_s i{0}; i < m; ++i) {
+      std::vector<type_v> q(qs.begin() + i * dim, qs.begin() + (i + 1) * dim);
+      const auto idx = kdtree::knn<double, type_s, dim, maj>(ctx, q, vec,
+                                                             n, dims, k);
+      CAPTURE(n);
+      CAPTURE(i);
+      for (type_s j{0}; j < k; ++j) CHECK(b_idx[i * k + j] == idx[j]);
+    }
+
+  }
+
+}
+
+template <std::size_t dim, kdtree::container::layout maj>
+static void
+test_knn_batch_impl(const std::size_t nthreads, const std::size_t n,
+                    const std::size_t m, const std::size_t k) {
+
+  using type_v = int;
+  using type_s = std::size_t;
+
+  kdtree::context ctx(nthreads);
+
+  std::vector<type_v> vec(dim * n);
+  generate_random_dataset(vec);
+  kdtree::create<type_s, dim, maj>(ctx, vec, n);
+
+  std::vector<type_v> qs(dim * m);
+  generate_random_dataset(qs);
+
+  std::vector<type_s> idx(m * k);
+  std::vector<double> dst(m * k);
+  kdtree::knn_batch<double, type_s, dim, maj>(ctx, qs, m, vec, n, k, 
+                                              idx, dst);
+
+  CAPTURE(nthreads);
+  CAPTURE(n);
+  CAPTURE(m);
+  CAPTURE(k);
+
+  std::vector<type_v> q(dim);
+  for (type_s i{0}; i < m; ++i) {
+    for (type_s e{0}; e < dim; ++e) {
+      q[e] = kdtree::container::id<type_s, dim, maj>(qs, m, i, e);
+    }
+    const auto ans = kdtree::knn<double, type_s, dim, maj>(ctx, q, vec, n, k);
+    for (type_s j{0}; j < k; ++j) {
+      CHECK(idx[i * k + j] == ans[j]);
+      if (j > 0) CHECK(dst[i * k + j - 1] <= dst[i * k + j]);
+    }
+    const double d0{kdtree::internal::dist::euclidian<double, type_s, dim, 
+                    maj, decltype(q), maj, decltype(vec)>(q, 1, 0, vec, n, 
+                                                          idx[i * k])};
+    CHECK(dst[i * k] == d0);
+  }
+
+}
+
+TEST_CASE("[batch] kdtree::knn_batch") {
+
+  constexpr auto row{kdtree::container::layout::row_major};
+  constexpr auto col{kdtree::container::layout::col_major};
+
+  for (std::size_t nthreads : {1, 3}) {
+    test_knn_batch_impl<2, row>(nthreads, 1 << 8,  100,  1);
+    test_knn_batch_impl<2, col>(nthreads, 1 << 8,  100,  4);
+    test_knn_batch_impl<3, row>(nthreads, 1000,    1000, 8);
+    test_knn_batch_impl<3, col>(nthreads, 1000,    1000, 8);
+    test_knn_batch_impl<5, row>(nthreads, 1 << 12, 257,  16);
+  }
+
+}
+
+template <std::size_t K>
+static void
+test_knn_fixed_impl(const std::size_t n) {
+
+  using type_v = int;
+  using type_s = std::size_t;
+  constexpr type_s dim{3};
+  constexpr auto   maj{kdtree::container::layout::row_major};
+
+  kdtree::context ctx;
+
+  std::vector<type_v> vec(dim * n);
+  generate_random_dataset(vec);
+  kdtree::create<type_s, dim, maj>(ctx, vec, n);
+
+  CAPTURE(K);
+  CAPTURE(n);
+
+  for (int i{0}; i < 16; ++i) {
+
+    // plain arrays, as a kernel would pass them.
+    type_v q[dim];
+    std::vector<type_v> q_(dim);
+    generate_random_dataset(q_);
+    std::copy(q_.begin(), q_.end(), q);
+
+    const auto idx = kdtree::knn<K, double, type_s, dim, maj>(ctx, q, 
+                                                              vec.data(), n);
+    const auto ans = kdtree::knn<double, type_s, dim, maj>(ctx, q_, vec, n, 
+                                                           type_s{K});
+    for (std::size_t j{0}; j < K; ++j) CHECK(idx[j] == ans[j]);
+
+  }
+
+}
+
+TEST_CASE("[fixed k] kdtree::knn<K>") {
+  test_knn_fixed_impl<1>(1000);
+  test_knn_fixed_impl<4>(1000);
+  test_knn_fixed_impl<16>(1000);
+  test_knn_fixed_impl<17>(1000);
+  test_knn_fixed_impl<32>(4096);
+}
+
+#ifdef KD__USING_SYCL
+TEST_CASE("[sycl] kdtree::knn<K>") {
+
+  using type_s = uint32_t;
+  constexpr type_s      dim{3};
+  constexpr type_s      n{2048};
+  constexpr std::size_t K{8};
+
+  kdtree::context ctx;
+  sycl::queue     queue{sycl::cpu_selector_v};
+
+  std::vector<int> vec(dim * n);
+  generate_random_dataset(vec);
+  kdtree::create<type_s, dim>(ctx, vec, n);
+
+  int*    usm_vec{sycl::malloc_shared<int>(dim * n, queue)};
+  type_s* usm_out{sycl::malloc_shared<type_s>(n * K, queue)};
+  std::copy(vec.begin(), vec.end(), usm_vec);
+
+  // kernels take the query fields only; the context owns the host pool.
+  const kdtree::query qctx{ctx};
+
+  queue.parallel_for(sycl::nd_range<1>(n, 64), [=](sycl::nd_item<1> item) {
+    const auto i{item.get_global_id(0)};
+    int q[dim];
+    for (type_s j{0}; j < dim; ++j) q[j] = usm_vec[i * dim + j];
+    const auto idx = kdtree::knn<K, double, type_s, dim>(qctx, q, usm_vec, n);
+    for (std::size_t j{0}; j < K; ++j) usm_out[i * K + j] = idx[j];
+  }).wait_and_throw();
+
+  for (type_s i{0}; i < n; i += 97) {
+    std::vector<int> q(vec.begin() + i * dim, vec.begin() + (i + 1) * dim);
+    const auto ans = kdtree::knn<double, type_s, dim>(ctx, q, vec, n, 
+                                                      type_s{K});
+    for (std::size_t j{0}; j < K; ++j) CHECK(usm_out[i * K + j] == ans[j]);
+  }
+
+  sycl::free(usm_vec, queue);
+  sycl::free(usm_out, queue);
+
+}
+#endif // KD__USING_SYCL
+
+TEST_CASE("[distances] kdtree::knn") {
+
+  using type_v = int;
+  using type_s = std::size_t;
+  constexpr type_s dim{3};
+  constexpr auto   maj{kdtree::container::layout::col_major};
+  constexpr type_s n{1000};
+
+  kdtree::context ctx;
+
+  std::vector<type_v> vec(dim * n);
+  generate_random_dataset(vec);
+  kdtree::create<type_s, dim, maj>(ctx, vec, n);
+
+  for (type_s k : {1, 7, 32}) {
+    for (bool euclidean : {false, true}) {
+
+      ctx.euclidean = euclidean;
+
+      std::vector<type_v> q(dim);
+      generate_random_dataset(q);
+
+      std::vector<type_s> idx(k);
+      std::vector<double> dst(k);
+      kdtree::knn<double, type_s, dim, maj>(ctx, q, vec, n, k, idx, dst);
+      const auto ans = kdtree::knn<double, type_s, dim, maj>(ctx, q, vec, n, k);
+
+      CAPTURE(k);
+      CAPTURE(euclidean);
+      for (type_s j{0}; j < k; ++j) {
+        CHECK(idx[j] == ans[j]);
+        const double d{kdtree::internal::dist::euclidian<double, type_s, dim,
+                       maj, decltype(q), maj, decltype(vec)>(q, 1, 0, vec, n,
+                                                             idx[j])};
+        CHECK(dst[j] == doctest::Approx(euclidean ? std::sqrt(d) : d));
+      }
+
+    }
+  }
+
+  // more neighbours than points: the extra slots keep their sentinel.
+  {
+    ctx.euclidean = true;
+    std::vector<type_v> q(dim, 0);
+    std::vector<type_s> idx(4);
+    std::vector<double> dst(4);
+    kdtree::knn<double, type_s, dim, maj>(ctx, q, vec, type_s{2}, type_s{4}, 
+                                          idx, dst);
+    CHECK(dst[2] == std::numeric_limits<double>::max());
+    CHECK(dst[3] == std::numeric_limits<double>::max());
+  }
+
+}
+
+// counts the points a traversal examines.
+template <typename F, typename T>
+struct counted_t : kdtree::internal::knn::result_t<F, T> {
+  using kdtree::internal::knn::result_t<F, T>::result_t;
+  std::size_t visits{0};
+};
+
+template <typename F, typename T, T dim, kdtree::container::layout maj,
+          typename C_query, typename C_tree>
+struct f_counted {
+  template <typename result_t>
+  void operator()(result_t& res, const C_query& q, const C_tree& src,
+                  const T n, const T idx, F* rmax) const {
+    ++res.visits;
+    kdtree::internal::knn::f_process<F, T, dim, maj, C_query, C_tree>{}(
+      res, q, src, n, idx, rmax);
+  }
+};
+
+template <typename V, std::size_t dim, kdtree::container::layout maj,
+          typename f_gen>
+static void
+test_knn_pruning_impl(const std::size_t n, const std::size_t k, f_gen&& gen) {
+
+  using type_s = std::size_t;
+  using C      = std::vector<V>;
+  using R      = counted_t<double, type_s>;
+  using f_proc = f_counted<double, type_s, dim, maj, C, C>;
+  using f_dim  = kdtree::internal::traverse::f_splitdim<type_s, dim, maj, C>;
+
+  kdtree::context ctx;
+
+  C vec(dim * n);
+  for (auto& x : vec) x = gen();
+  kdtree::create<type_s, dim, maj>(ctx, vec, n);
+
+  const auto d = [&](const C& q, const type_s i) {
+    return kdtree::internal::dist::euclidian<double, type_s, dim, maj,
+                                             C, maj, C>(q, 1, 0, vec, n, i);
+  };
+
+  std::size_t plane{0};
+  std::size_t cell{0};
+  std::size_t stack{0};
+
+  CAPTURE(n);
+  CAPTURE(k);
+
+  for (int i{0}; i < 32; ++i) {
+
+    C q(dim);
+    for (auto& x : q) x = gen();
+
+    // ties are common for small integer ranges, so distances are compared.
+    const auto ans = ref::knn<double, type_s, dim, maj>(ctx, q, vec, n, k);
+
+    for (bool c : {false, true}) {
+      ctx.cell = c;
+      const auto idx = kdtree::knn<double, type_s, dim, maj>(ctx, q, vec, 
+                                                             n, k);
+      CAPTURE(c);
+      for (type_s j{0}; j < k; ++j) CHECK(d(q, idx[j]) == d(q, ans[j]));
+    }
+
+    R r0(k);
+    R r1(k);
+    R r2(k);
+    kdtree::traverse<R, f_proc, f_dim, double, type_s, dim, maj, C, C, 
+                     false>(r0, q, vec, n, std::numeric_limits<double>::max());
+    kdtree::traverse<R, f_proc, f_dim, double, type_s, dim, maj, C, C, 
+                     true >(r1, q, vec, n, std::numeric_limits<double>::max());
+    kdtree::traverse_stack<R, f_proc, f_dim, double, type_s, dim, maj, C, C>(
+      r2, q, vec, n, std::numeric_limits<double>::max());
+    plane += r0.visits;
+    cell  += r1.visits;
+    stack += r2.visits;
+
+    // the stack walk keeps the order of the stackless one with a bound at
+    // least as tight.
+    kdtree::internal::knn::heapsort<type_s, dim, maj>(r0.idx, r0.dst, k);
+    kdtree::internal::knn::heapsort<type_s, dim, maj>(r2.idx, r2.dst, k);
+    CHECK(r2.dst == r0.dst);
+
+    // with eps > 0 the stack walk prunes as traverse does and stays within
+    // (1 + eps) of the exact distances.
+    {
+      constexpr float  eps  { 0.5f                      };
+      constexpr double grow { (1.0 + eps) * (1.0 + eps) };
+      R ra(k);
+      R rs(k);
+      CHECK(kdtree::traverse<R, f_proc, f_dim, double, type_s, dim, maj, C, C>(
+        ra, q, vec, n, std::numeric_limits<double>::max(), f_dim{}, eps));
+      CHECK(kdtree::traverse_stack<R, f_proc, f_dim, double, type_s, dim, maj,
+                                   C, C>(
+        rs, q, vec, n, std::numeric_limits<double>::max(), f_dim{}, eps));
+      CHECK(rs.visits <= ra.visits);
+      CHECK(rs.visits <= r2.visits);
+      kdtree::internal::knn::heapsort<type_s, dim, maj>(rs.idx, rs.dst, k);
+      for (type_s j{0}; j < k; ++j) CHECK(rs.dst[j] <= grow * d(q, ans[j]));
+    }
+
+    // a budget that runs out stops both walks after that many points and
+    // reports an inexact result; one that covers the walk changes nothing.
+    {
+      const std::size_t budget{r2.visits / 2};
+      REQUIRE(budget > 0);
+      R rb(k);
+      R rt(k);
+      R rc(k);
+      CHECK_FALSE(kdtree::traverse_stack<R, f_proc, f_dim, double, type_s, 
+                                         dim, maj, C, C>(
+        rb, q, vec, n, std::numeric_limits<double>::max(), f_dim{}, 0.0f,
+        budget));
+      CHECK_FALSE(kdtree::traverse<R, f_proc, f_dim, double, type_s, dim, 
+                                   maj, C, C>(
+        rt, q, vec, n, std::numeric_limits<double>::max(), f_dim{}, 0.0f,
+        budget));
+      CHECK(rb.visits == budget);
+      CHECK(rt.visits == budget);
+      CHECK(kdtree::traverse_stack<R, f_proc, f_dim, double, type_s, dim, maj,
+                                   C, C>(
+        rc, q, vec, n, std::numeric_limits<double>::max(), f_dim{}, 0.0f,
+        r2.visits));
+      CHECK(rc.visits == r2.visits);
+      kdtree::internal::knn::heapsort<type_s, dim, maj>(rc.idx, rc.dst, k);
+      CHECK(rc.dst == r2.dst);
+    }
+
+  }
+
+  CHECK(cell  <= plane);
+  CHECK(stack <= plane);
+  CHECK(plane <  32 * n);
+
+}
+
+TEST_CASE("[pruning] kdtree::knn") {
+
+  constexpr auto row{kdtree::container::layout::row_major};
+  constexpr auto col{kdtree::container::layout::col_major};
+
+  std::mt19937 gen(std::random_device{}());
+  std::uniform_real_distribution<float>   unit(0.0f, 1.0f);
+  std::uniform_int_distribution<uint16_t> small(0, 64);
+
+  // distances below one were compared against linear plane offsets.
+  test_knn_pruning_impl<float, 3, row>(4096, 8, [&] { return unit(gen); });
+  test_knn_pruning_impl<float, 3, col>(4096, 1, [&] { return unit(gen); });
+  test_knn_pruning_impl<float, 5, row>(4096, 4, [&] { return unit(gen); });
+
+  // unsigned offsets used to wrap around when the query lay below the plane.
+  test_knn_pruning_impl<uint16_t, 3, row>(4096, 8, [&] { return small(gen); });
+  test_knn_pruning_impl<uint16_t, 2, col>(1000, 3, [&] { return small(gen); });
+
+}
+
+TEST_CASE("[approximate] kdtree::knn") {
+
+  using type_v = float;
+  using type_s = std::size_t;
+  using C      = std::vector<type_v>;
+  constexpr type_s dim{3};
+  constexpr auto   maj{kdtree::container::layout::row_major};
+  constexpr type_s n{1 << 13};
+  constexpr type_s k{8};
+
+  std::mt19937 gen(std::random_device{}());
+  std::uniform_real_distribution<type_v> unit(0.0f, 1.0f);
+
+  kdtree::context ctx;
+
+  C vec(dim * n);
+  for (auto& x : vec) x = unit(gen);
+  kdtree::create<type_s, dim, maj>(ctx, vec, n);
+
+  const auto d = [&](const C& q, const type_s i) {
+    return kdtree::internal::dist::euclidian<double, type_s, dim, maj,
+                                             C, maj, C>(q, 1, 0, vec, n, i);
+  };
+
+  for (float eps : {0.1f, 0.5f, 2.0f}) {
+    for (bool cell : {false, true}) {
+
+      ctx.eps  = eps;
+      ctx.cell = cell;
+
+      CAPTURE(eps);
+      CAPTURE(cell);
+
+      for (int i{0}; i < 32; ++i) {
+        C q(dim);
+        for (auto& x : q) x = unit(gen);
+        const auto idx = kdtree::knn<double, type_s, dim, maj>(ctx, q, vec,
+                                                               n, k);
+        const auto ans = ref::knn<double, type_s, dim, maj>(ctx, q, vec, 
+                                                            n, k);
+        const double grow{(1.0 + eps) * (1.0 + eps)};
+        for (type_s j{0}; j < k; ++j) {
+          CHECK(d(q, idx[j]) <= grow * d(q, ans[j]));
+        }
+      }
+
+    }
+  }
+
+}
+
+TEST_CASE("[budget] kdtree::knn") {
+
+  using type_v = int;
+  using type_s = std::size_t;
+  constexpr type_s dim{3};
+  constexpr auto   maj{kdtree::container::layout::row_major};
+  constexpr type_s n{1 << 12};
+  constexpr type_s k{8};
+
+  kdtree::context ctx;
+
+  std::vector<type_v> vec(dim * n);
+  generate_random_dataset(vec);
+  kdtree::create<type_s, dim, maj>(ctx, vec, n);
+
+  for (int i{0}; i < 16; ++i) {
+
+    std::vector<type_v> q(dim);
+    generate_random_dataset(q);
+
+    ctx.budget = 0;
+    const auto ans = kdtree::knn<double, type_s, dim, maj>(ctx, q, vec, n, k);
+
+    // a budget is a prefix of the same walk, so the k-th distance can only
+    // improve as it grows.
+    double worst{std::numeric_limits<double>::max()};
+
+    for (type_s budget : {1, 8, 64, 512}) {
+
+      ctx.budget = budget;
+
+      std::vector<type_s> idx(k);
+      std::vector<double> dst(k);
+      const bool exact = kdtree::knn<double, type_s, dim, maj>(ctx, q, vec, 
+                                                               n, k, idx, 
+                                                               dst);
+
+      CAPTURE(budget);
+      if (budget < k) CHECK_FALSE(exact);
+      for (type_s j{1}; j < k; ++j) CHECK(dst[j - 1] <= dst[j]);
+      CHECK(dst[k - 1] <= worst);
+      worst = dst[k - 1];
+
+    }
+
+    ctx.budget = n;
+
+    std::vector<type_s> idx(k);
+    std::vector<double> dst(k);
+    CHECK(kdtree::knn<double, type_s, dim, maj>(ctx, q, vec, n, k, idx, dst));
+    for (type_s j{0}; j < k; ++j) CHECK(idx[j] == ans[j]);
+
+  }
+
+  // a single evaluation can only reach the root.
+  {
+    ctx.budget = 1;
+    std::vector<type_v> q(dim, 0);
+    std::vector<type_s> idx(2);
+    std::vector<double> dst(2);
+    CHECK_FALSE(kdtree::knn<double, type_s, dim, maj>(ctx, q, vec, n, 
+                                                      type_s{2}, idx, dst));
+    CHECK(idx[0] == 0);
+    CHECK(dst[1] == std::numeric_limits<double>::max());
+  }
+
+}
+
+TEST_CASE("[bbf] kdtree::knn") {
+
+  using type_v = float;
+  using type_s = std::size_t;
+  using C      = std::vector<type_v>;
+  constexpr type_s dim{3};
+  constexpr auto   maj{kdtree::container::layout::col_major};
+  constexpr type_s n{1 << 13};
+  constexpr type_s k{8};
+
+  // clustered points: a few tight blobs in the unit cube.
+  std::mt19937 gen(std::random_device{}());
+  std::uniform_real_distribution<type_v> unit(0.0f, 1.0f);
+  std::normal_distribution<type_v>       blob(0.0f, 0.01f);
+
+  C centres(dim * 16);
+  for (auto& x : centres) x = unit(gen);
+
+  C vec(dim * n);
+  for (type_s i{0}; i < n; ++i) {
+    const type_s c{i % 16};
+    for (type_s e{0}; e < dim; ++e) {
+      vec[e * n + i] = centres[c * dim + e] + blob(gen);
+    }
+  }
+
+  kdtree::context ctx;
+  kdtree::create<type_s, dim, maj>(ctx, vec, n);
+  ctx.walk = kdtree::walker::best;
+
+  const auto d = [&](const C& q, const type_s i) {
+    return kdtree::internal::dist::euclidian<double, type_s, dim, maj,
+                                             C, maj, C>(q, 1, 0, vec, n, i);
+  };
+
+  using R      = kdtree::internal::knn::result_t<double, type_s>;
+  using f_proc = kdtree::internal::knn::f_process<double, type_s, dim, maj, 
+                                                  C, C>;
+  using f_dim  = kdtree::internal::traverse::f_splitdim<type_s, dim, maj, C>;
+
+  for (int i{0}; i < 32; ++i) {
+
+    C q(dim);
+    for (auto& x : q) x = unit(gen);
+
+    const auto ans = ref::knn<double, type_s, dim, maj>(ctx, q, vec, n, k);
+
+    std::vector<type_s> idx(k);
+    std::vector<double> dst(k);
+    CHECK(kdtree::knn<double, type_s, dim, maj>(ctx, q, vec, n, k, idx, dst));
+    for (type_s j{0}; j < k; ++j) CHECK(d(q, idx[j]) == d(q, ans[j]));
+
+    // a queue of two overflows all the time; the overflow is walked depth
+    // first and the result stays exact.
+    R res(k);
+    CHECK(kdtree::traverse_bbf<R, f_proc, f_dim, double, type_s, dim, maj,
+                               C, C, 2>(res, q, vec, n,
+                                        std::numeric_limits<double>::max()));
+    kdtree::internal::knn::heapsort<type_s, dim, maj>(res.idx, res.dst, k);
+    for (type_s j{0}; j < k; ++j) CHECK(res.dst[j] == d(q, ans[j]));
+
+  }
+
+}
+
+TEST_CASE("[warm] kdtree::knn") {
+
+  using type_v = float;
+  using type_s = std::size_t;
+  using C      = std::vector<type_v>;
+  constexpr type_s dim{3};
+  constexpr auto   maj{kdtree::container::layout::row_major};
+  constexpr type_s n{1 << 12};
+  constexpr type_s k{8};
+
+  std::mt19937 gen(std::random_device{}());
+  std::uniform_real_distribution<type_v> unit(0.0f, 1.0f);
+  std::uniform_real_distribution<type_v> step(-0.01f, 0.01f);
+
+  kdtree::context ctx;
+
+  C vec(dim * n);
+  for (auto& x : vec) x = unit(gen);
+  kdtree::create<type_s, dim, maj>(ctx, vec, n);
+
+  for (int i{0}; i < 32; ++i) {
+
+    C q(dim);
+    for (auto& x : q) x = unit(gen);
+
+    std::vector<type_s> idx(k);
+    std::vector<double> dst(k);
+    kdtree::knn<double, type_s, dim, maj>(ctx, q, vec, n, k, idx, dst);
+
+    // the point moves a little; last step's neighbours seed the query in
+    // place.
+    for (auto& x : q) x += step(gen);
+
+    std::vector<type_s> ans(k);
+    std::vector<double> ans_dst(k);
+    kdtree::knn<double, type_s, dim, maj>(ctx, q, vec, n, k, ans, ans_dst);
+
+    CHECK(kdtree::knn<double, type_s, dim, maj>(ctx, q, vec, n, k, idx, k,
+                                                idx, dst));
+    CHECK(dst == ans_dst);
+
+    // repeats, indices outside the tree and more seeds than slots.
+    std::vector<type_s> seed{n, 3, 3, n + 7, 5, 1, 2, 4, 6, 7, 8, 9, 3};
+    CHECK(kdtree::knn<double, type_s, dim, maj>(ctx, q, vec, n, k, seed, 
+                                                type_s{13}, idx, dst));
+    CHECK(dst == ans_dst);
+
+  }
+
+  // fewer points than neighbours: the extra slots keep their sentinel.
+  {
+    C q(dim, 0.5f);
+    std::vector<type_s> seed{0, 0, 1};
+    std::vector<type_s> idx(4);
+    std::vector<double> dst(4);
+    kdtree::knn<double, type_s, dim, maj>(ctx, q, vec, type_s{2}, type_s{4},
+                                          seed, type_s{3}, idx, dst);
+    CHECK(idx[0] != idx[1]);
+    CHECK(dst[1] <  std::numeric_limits<double>::max());
+    CHECK(dst[2] == std::numeric_limits<double>::max());
+  }
+
+}
+
+template <std::size_t dim, kdtree::container::layout maj>
+static void
+test_self_knn_impl(const std::size_t nthreads, const std::size_t n,
+                   const std::size_t k, const int range) {
+
+  using type_v = int;
+  using type_s = std::size_t;
+
+  // a small range packs coincident points into the tree.
+  std::mt19937 gen(std::random_device{}());
+  std::uniform_int_distribution<type_v> coord(0, range);
+
+  kdtree::context ctx(nthreads);
+
+  // the walk ignores any budget.
+  ctx.budget = nthreads > 1 ? 4 : 0;
+
+  std::vector<type_v> vec(dim * n);
+  for (auto& x : vec) x = coord(gen);
+  kdtree::create<type_s, dim, maj>(ctx, vec, n);
+
+  std::vector<type_s> idx(n * k);
+  std::vector<double> dst(n * k);
+  kdtree::self_knn<double, type_s, dim, maj>(ctx, vec, n, k, idx, dst);
+
+  CAPTURE(nthreads);
+  CAPTURE(dim);
+  CAPTURE(n);
+  CAPTURE(k);
+
+  const auto d = [&](const type_s i, const type_s j) {
+    double s{0};
+    for (type_s e{0}; e < dim; ++e) {
+      const double x{
+        static_cast<double>(kdtree::container::id<type_s, dim, maj>(
+          vec, n, i, e))
+      - static_cast<double>(kdtree::container::id<type_s, dim, maj>(
+          vec, n, j, e))};
+      s += x * x;
+    }
+    return s;
+  };
+
+  const type_s found{k < n - 1 ? k : n - 1};
+
+  for (type_s i{0}; i < n; ++i) {
+
+    std::vector<double> ans;
+    for (type_s j{0}; j < n; ++j) {
+      if (j != i) ans.push_back(d(i, j));
+    }
+    std::sort(ans.begin(), ans.end());
+
+    for (type_s j{0}; j < found; ++j) {
+      CHECK(idx[i * k + j] != i);
+      CHECK(dst[i * k + j] == ans[j]);
+      CHECK(dst[i * k + j] == d(i, idx[i * k + j]));
+    }
+    for (type_s j{found}; j < k; ++j) {
+      CHECK(dst[i * k + j] == std::numeric_limits<double>::max());
+    }
+
+  }
+
+}
+
+TEST_CASE("[self] kdtree::self_knn") {
+
+  constexpr auto row{kdtree::container::layout::row_major};
+  constexpr auto col{kdtree::container::layout::col_major};
+
+  for (std::size_t nthreads : {1, 3}) {
+    test_self_knn_impl<2, row>(nthreads, 1 << 8,  1,  1 << 20);
+    test_self_knn_impl<2, col>(nthreads, 1000,    4,  8);
+    test_self_knn_impl<3, row>(nthreads, 1000,    8,  4);
+    test_self_knn_impl<3, col>(nthreads, 1 << 11, 17, 1 << 10);
+    test_self_knn_impl<5, row>(nthreads, 777,     16, 3);
+  }
+
+  // fewer points than neighbours.
+  test_self_knn_impl<3, row>(1, 1, 2, 10);
+  test_self_knn_impl<3, row>(1, 5, 8, 10);
+
+  // one point per work item, as a kernel would run it.
+  {
+    using type_s = std::size_t;
+    constexpr type_s dim{3};
+    constexpr type_s n{1 << 10};
+
+    kdtree::context ctx;
+
+    std::vector<int> vec(dim * n);
+    generate_random_dataset(vec);
+    kdtree::create<type_s, dim>(ctx, vec, n);
+
+    std::vector<type_s> idx(n * 20);
+    std::vector<double> dst(n * 20);
+    kdtree::self_knn<double, type_s, dim>(ctx, vec, n, type_s{20}, idx, dst);
+
+    for (type_s i{0}; i < n; ++i) {
+      const auto a = kdtree::self_knn<4,  double, type_s, dim>(ctx, vec.data(),
+                                                               n, i);
+      const auto b = kdtree::self_knn<20, double, type_s, dim>(ctx, vec, n, i);
+      for (std::size_t j{0}; j < 4;  ++j) CHECK(a[j] == idx[i * 20 + j]);
+      for (std::size_t j{0}; j < 20; ++j) CHECK(b[j] == idx[i * 20 + j]);
+    }
+  }
+
+}
+
+template <std::size_t dim, kdtree::container::layout maj>
+static void
+test_knn_graph_impl(const std::size_t nthreads, const std::size_t n,
+                    const std::size_t k, const int range) {
+
+  using type_v = int;
+  using type_s = std::size_t;
+
+  std::mt19937 gen(std::random_device{}());
+  std::uniform_int_distribution<type_v> coord(0, range);
+
+  kdtree::context ctx(nthreads);
+
+  std::vector<type_v> vec(dim * n);
+  for (auto& x : vec) x = coord(gen);
+  kdtree::create<type_s, dim, maj>(ctx, vec, n);
+
+  CAPTURE(nthreads);
+  CAPTURE(dim);
+  CAPTURE(n);
+  CAPTURE(k);
+
+  const type_s w{k < n - 1 ? k : n - 1};
+
+  std::vector<type_s> s_idx(n * w);
+  std::vector<double> s_dst(n * w);
+  kdtree::self_knn<double, type_s, dim, maj>(ctx, vec, n, w, s_idx, s_dst);
+
+  // the plain graph is self_knn in CSR form.
+  std::vector<type_s> off, idx;
+  std::vector<double> dst;
+  kdtree::knn_graph<double, type_s, dim, maj>(ctx, vec, n, k, off, idx, dst);
+
+  REQUIRE(off.size() == n + 1);
+  for (type_s i{0}; i <= n; ++i) CHECK(off[i] == i * w);
+  CHECK(idx == s_idx);
+  CHECK(dst == s_dst);
+
+  // the symmetric one: every row is the union of the point's own neighbours
+  // and the points that have it as one, in ascending order.
+  kdtree::knn_graph<double, type_s, dim, maj>(ctx, vec, n, k, off, idx, dst,
+                                              true);
+
+  REQUIRE(off.size() == n + 1);
+  REQUIRE(idx.size() == off[n]);
+  REQUIRE(dst.size() == off[n]);
+
+  std::vector<std::vector<type_s>> ans(n);
+  for (type_s i{0}; i < n; ++i) {
+    for (type_s j{0}; j < w; ++j) {
+      ans[i].push_back(s_idx[i * w + j]);
+      ans[s_idx[i * w + j]].push_back(i);
+    }
+  }
+
+  for (type_s i{0}; i < n; ++i) {
+
+    std::sort(ans[i].begin(), ans[i].end());
+    ans[i].erase(std::unique(ans[i].begin(), ans[i].end()), ans[i].end());
+
+    std::vector<type_s> row(idx.begin() + off[i], idx.begin() + off[i + 1]);
+    std::sort(row.begin(), row.end());
+    CHECK(row == ans[i]);
+
+    // its own neighbours come first.
+    for (type_s j{0}; j < w; ++j) CHECK(dst[off[i] + j] == s_dst[i * w + j]);
+    for (type_s p{off[i] + 1}; p < off[i + 1]; ++p) {
+      CHECK(dst[p - 1] <= dst[p]);
+    }
+
+  }
+
+}
+
+TEST_CASE("[graph] kdtree::knn_graph") {
+
+  constexpr auto row{kdtree::container::layout::row_major};
+  constexpr auto col{kdtree::container::layout::col_major};
+
+  for (std::size_t nthreads : {1, 3}) {
+    test_knn_graph_impl<2, row>(nthreads, 1 << 8,  1,  1 << 20);
+    test_knn_graph_impl<2, col>(nthreads, 1000,    4,  8);
+    test_knn_graph_impl<3, row>(nthreads, 1000,    8,  1 << 10);
+    test_knn_graph_impl<3, col>(nthreads, 1 << 11, 16, 4);
+  }
+
+  // fewer points than neighbours.
+  test_knn_graph_impl<3, row>(1, 5, 8, 10);
+  test_knn_graph_impl<3, row>(1, 1, 2, 10);
+
+}
+
+TEST_CASE("[adaptive] kdtree::self_knn") {
+
+  using type_v = int;
+  using type_s = std::size_t;
+  constexpr type_s dim{3};
+  constexpr auto   maj{kdtree::container::layout::row_major};
+
+  for (type_s n : {1, 2, 9, 1000, 5000}) {
+
+    // squashed axes, so the adaptive splits differ from round robin.
+    kdtree::context ctx;
+    std::vector<type_v> vec(dim * n);
+    generate_random_dataset(vec);
+    for (type_s i{0}; i < n; ++i) {
+      vec[i * dim + 1] /= 1 << 6;
+      vec[i * dim + 2] /= 1 << 12;
+    }
+
+    std::vector<std::uint8_t> dims;
+    kdtree::create<type_s, dim, maj>(ctx, vec, n, dims);
+
+    CAPTURE(n);
+
+    const type_s k{std::min<type_s>(8, n - 1)};
+
+    std::vector<type_s> idx(n * k);
+    std::vector<double> dst(n * k);
+    kdtree::self_knn<double, type_s, dim, maj>(ctx, vec, n, dims, k,
+                                               idx, dst);
+
+    std::vector<type_s> off, g_idx;
+    std::vector<double> g_dst;
+    kdtree::knn_graph<double, type_s, dim, maj>(ctx, vec, n, dims, k,
+                                                off, g_idx, g_dst);
+    CHECK(g_idx == idx);
+
+    for (type_s i{0}; i < n; ++i) {
+
+      std::vector<type_v> q(vec.begin() + i * dim,
+                            vec.begin() + (i + 1) * dim);
+      const auto ans = ref::knn<double, type_s, dim, maj>(ctx, q, vec, n,
+                                                          k + 1);
+      std::vector<type_s> row(idx.begin() + i * k, idx.begin() + (i + 1) * k);
+      std::vector<type_s> exp;
+      for (const auto j : ans) if (j != i && exp.size() < k) exp.push_back(j);
+      CHECK(row == exp);
+
+      const auto one = kdtree::self_knn<4, double, type_s, dim, maj>(
+        ctx, vec, n, dims, i);
+      for (std::size_t j{0}; j < std::min<type_s>(4, k); ++j) {
+        CHECK(one[j] == row[j]);
+      }
+
+    }
+
+  }
+
+}
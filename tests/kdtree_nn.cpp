@@ -22,6 +22,7 @@
 #include "pch.h"
 
 #include <nn/nn.hpp>
+#include <nn/batch.hpp>
 #include <create/create.hpp>
 
 TEST_CASE("[basic_example] kdtree::nn") {
@@ -251,7 +252,7 @@ test_nn_impl(void) {
   std::vector<type_v> vec(dim * n);
   generate_random_dataset(vec);
 
-  kdtree::create<type_s, dim>(ctx, vec, n);
+  kdtree::create<type_s, dim, maj>(ctx, vec, n);
 
   for (std::size_t i = 0; i < imax; ++i) {
     SUBCASE(("nn check, i=" + std::to_string(i)).c_str()) {
@@ -327,3 +328,321 @@ TEST_CASE("[random][case=1] kdtree::nn multiple dims/n") {
 
 }
 
+
+TEST_CASE("[adaptive] kdtree::nn") {
+
+  using type_v = int;
+  using type_s = std::size_t;
+  constexpr type_s dim{3};
+  constexpr auto   maj{kdtree::container::layout::row_major};
+
+  // a thin slab, so the recorded split dimensions differ from round robin.
+
+  for (type_s n : {1, 2, 9, 1000, 5000}) {
+
+    kdtree::context ctx;
+    std::vector<type_v> vec(dim * n);
+    generate_random_dataset(vec);
+    for (type_s i{0}; i < n; ++i) {
+      vec[i * dim + 1] /= 1 << 6;
+      vec[i * dim + 2] /= 1 << 12;
+    }
+
+    std::vector<std::uint8_t> dims;
+    kdtree::create<type_s, dim, maj>(ctx, vec, n, dims);
+
+    for (int i{0}; i < 16; ++i) {
+      std::vector<type_v> q(dim);
+      generate_random_dataset(q);
+      q[1] /= 1 << 6;
+      q[2] /= 1 << 12;
+      CAPTURE(n);
+      const auto idx = kdtree::nn<double, type_s, dim, maj>(ctx, q, vec,
+                                                            n, dims);
+      const auto ans = ref::nn<double, type_s, dim, maj>(ctx, q, vec, n);
+      CHECK(idx == ans);
+    }
+
+    constexpr type_s m{64};
+    std::vector<type_v> qs(dim * m);
+    generate_random_dataset(qs);
+    std::vector<type_s> b_idx(m);
+    std::vector<double> b_dst(m);
+    kdtree::nn_batch<double, type_s, dim, maj>(ctx, qs, m, vec, n, dims,
+                                               b_idx, b_dst);
+    for (type_s i{0}; i < m; ++i) {
+      std::vector<type_v> q(qs.begin() + i * dim, qs.begin() + (i + 1) * dim);
+      CAPTURE(n);
+      CAPTURE(i);
+      CHECK(b_idx[i] == kdtree::nn<double, type_s, dim, maj>(ctx, q, vec,
+                                                             n, dims));
+    }
+
+  }
+
+}
+
+TEST_CASE("[batch] kdtree::nn_batch") {
+
+  using type_v = int;
+  using type_s = std::size_t;
+  constexpr type_s dim{3};
+
+  const auto run = [&](auto maj_, const std::size_t nthreads, 
+                       const type_s n, const type_s m) {
+
+    constexpr auto maj{decltype(maj_)::value};
+
+    kdtree::context ctx(nthreads);
+
+    std::vector<type_v> vec(dim * n);
+    generate_random_dataset(vec);
+    kdtree::create<type_s, dim, maj>(ctx, vec, n);
+
+    std::vector<type_v> qs(dim * m);
+    generate_random_dataset(qs);
+
+    std::vector<type_s> idx(m);
+    std::vector<double> dst(m);
+    kdtree::nn_batch<double, type_s, dim, maj>(ctx, qs, m, vec, n, idx, dst);
+
+    CAPTURE(nthreads);
+    CAPTURE(n);
+
+    std::vector<type_v> q(dim);
+    for (type_s i{0}; i < m; ++i) {
+      for (type_s e{0}; e < dim; ++e) {
+        q[e] = kdtree::container::id<type_s, dim, maj>(qs, m, i, e);
+      }
+      CHECK(idx[i] == kdtree::nn<double, type_s, dim, maj>(ctx, q, vec, n));
+      CHECK(dst[i] == kdtree::internal::dist::euclidian<double, type_s, dim,
+                      maj, decltype(q), maj, decltype(vec)>(q, 1, 0, vec, n,
+                                                            idx[i]));
+    }
+
+  };
+
+  using row = std::integral_constant<kdtree::container::layout,
+                                     kdtree::container::layout::row_major>;
+  using col = std::integral_constant<kdtree::container::layout,
+                                     kdtree::container::layout::col_major>;
+
+  for (std::size_t nthreads : {1, 4}) {
+    run(row{}, nthreads, 1,    10);
+    run(row{}, nthreads, 1000, 1000);
+    run(col{}, nthreads, 1000, 777);
+  }
+
+}
+
+TEST_CASE("[distances] kdtree::nn") {
+
+  using type_v = int;
+  using type_s = std::size_t;
+  constexpr type_s dim{2};
+  constexpr auto   maj{kdtree::container::layout::row_major};
+  constexpr type_s n{1 << 10};
+
+  kdtree::context ctx;
+
+  std::vector<type_v> vec(dim * n);
+  generate_random_dataset(vec);
+  kdtree::create<type_s, dim, maj>(ctx, vec, n);
+
+  for (int i{0}; i < 16; ++i) {
+
+    ctx.euclidean = (i % 2 == 1);
+
+    std::vector<type_v> q(dim);
+    generate_random_dataset(q);
+
+    type_s idx;
+    double dst;
+    kdtree::nn<double, type_s, dim, maj>(ctx, q, vec, n, idx, dst);
+
+    CHECK(idx == kdtree::nn<double, type_s, dim, maj>(ctx, q, vec, n));
+    const double d{kdtree::internal::dist::euclidian<double, type_s, dim, 
+                   maj, decltype(q), maj, decltype(vec)>(q, 1, 0, vec, n, 
+                                                         idx)};
+    CHECK(dst == doctest::Approx(ctx.euclidean ? std::sqrt(d) : d));
+
+  }
+
+}
+
+TEST_CASE("[pruning] kdtree::nn") {
+
+  using type_v = float;
+  using type_s = std::size_t;
+  constexpr type_s dim{3};
+  constexpr auto   maj{kdtree::container::layout::col_major};
+  constexpr type_s n{4096};
+
+  // all squared distances are below one, where pruning went wrong when it
+  // compared them to linear plane offsets.
+  std::mt19937 gen(std::random_device{}());
+  std::uniform_real_distribution<type_v> unit(0.0f, 1.0f);
+
+  kdtree::context ctx;
+
+  std::vector<type_v> vec(dim * n);
+  for (auto& x : vec) x = unit(gen);
+  kdtree::create<type_s, dim, maj>(ctx, vec, n);
+
+  for (int i{0}; i < 64; ++i) {
+
+    ctx.cell = (i % 2 == 1);
+
+    std::vector<type_v> q(dim);
+    for (auto& x : q) x = unit(gen);
+
+    CAPTURE(ctx.cell);
+    const auto idx = kdtree::nn<double, type_s, dim, maj>(ctx, q, vec, n);
+    const auto ans = ref::nn<double, type_s, dim, maj>(ctx, q, vec, n);
+    CHECK(idx == ans);
+
+  }
+
+}
+
+TEST_CASE("[approximate] kdtree::nn") {
+
+  using type_v = float;
+  using type_s = std::size_t;
+  constexpr type_s dim{3};
+  constexpr auto   maj{kdtree::container::layout::row_major};
+  constexpr type_s n{1 << 13};
+
+  std::mt19937 gen(std::random_device{}());
+  std::uniform_real_distribution<type_v> unit(0.0f, 1.0f);
+
+  kdtree::context ctx;
+
+  std::vector<type_v> vec(dim * n);
+  for (auto& x : vec) x = unit(gen);
+  kdtree::create<type_s, dim, maj>(ctx, vec, n);
+
+  for (float eps : {0.1f, 0.5f}) {
+
+    ctx.eps = eps;
+
+    for (int i{0}; i < 64; ++i) {
+
+      std::vector<type_v> q(dim);
+      for (auto& x : q) x = unit(gen);
+
+      type_s idx;
+      double dst;
+      kdtree::nn<double, type_s, dim, maj>(ctx, q, vec, n, idx, dst);
+      const auto ans = ref::nn<double, type_s, dim, maj>(ctx, q, vec, n);
+      const double d{kdtree::internal::dist::euclidian<double, type_s, dim, 
+                     maj, decltype(q), maj, decltype(vec)>(q, 1, 0, vec, n, 
+                                                           ans)};
+
+      CAPTURE(eps);
+      CHECK(dst <= (1.0 + eps) * (1.0 + eps) * d);
+
+    }
+
+  }
+
+}
+
+TEST_CASE("[budget] kdtree::nn") {
+
+  using type_v = int;
+  using type_s = std::size_t;
+  constexpr type_s dim{3};
+  constexpr auto   maj{kdtree::container::layout::col_major};
+  constexpr type_s n{1 << 12};
+
+  kdtree::context ctx;
+
+  std::vector<type_v> vec(dim * n);
+  generate_random_dataset(vec);
+  kdtree::create<type_s, dim, maj>(ctx, vec, n);
+
+  for (int i{0}; i < 16; ++i) {
+
+    std::vector<type_v> q(dim);
+    generate_random_dataset(q);
+
+    type_s idx;
+    double dst;
+
+    ctx.budget = 4;
+    CHECK_FALSE(kdtree::nn<double, type_s, dim, maj>(ctx, q, vec, n, 
+                                                     idx, dst));
+    const double d4{dst};
+
+    ctx.budget = n;
+    CHECK(kdtree::nn<double, type_s, dim, maj>(ctx, q, vec, n, idx, dst));
+    CHECK(idx == ref::nn<double, type_s, dim, maj>(ctx, q, vec, n));
+    CHECK(dst <= d4);
+
+  }
+
+}
+
+TEST_CASE("[bbf] kdtree::nn") {
+
+  using type_v = int;
+  using type_s = std::size_t;
+  constexpr type_s dim{4};
+  constexpr auto   maj{kdtree::container::layout::row_major};
+  constexpr type_s n{1 << 12};
+
+  kdtree::context ctx;
+
+  std::vector<type_v> vec(dim * n);
+  generate_random_dataset(vec);
+  kdtree::create<type_s, dim, maj>(ctx, vec, n);
+
+  ctx.walk = kdtree::walker::best;
+
+  for (int i{0}; i < 32; ++i) {
+    std::vector<type_v> q(dim);
+    generate_random_dataset(q);
+    const auto idx = kdtree::nn<double, type_s, dim, maj>(ctx, q, vec, n);
+    const auto ans = ref::nn<double, type_s, dim, maj>(ctx, q, vec, n);
+    CHECK(idx == ans);
+  }
+
+}
+
+TEST_CASE("[warm] kdtree::nn") {
+
+  using type_v = int;
+  using type_s = std::size_t;
+  constexpr type_s dim{3};
+  constexpr auto   maj{kdtree::container::layout::row_major};
+  constexpr type_s n{1 << 12};
+
+  kdtree::context ctx;
+
+  std::vector<type_v> vec(dim * n);
+  generate_random_dataset(vec);
+  kdtree::create<type_s, dim, maj>(ctx, vec, n);
+
+  for (int i{0}; i < 32; ++i) {
+
+    std::vector<type_v> q(dim);
+    generate_random_dataset(q);
+
+    const auto ans = ref::nn<double, type_s, dim, maj>(ctx, q, vec, n);
+    const auto any = static_cast<type_s>(i) * 97 % n;
+
+    // a good seed, a poor one and one outside the tree.
+    for (const auto& seed : {std::vector<type_s>{ans},
+                             std::vector<type_s>{any, n}}) {
+      type_s idx;
+      double dst;
+      CHECK(kdtree::nn<double, type_s, dim, maj>(ctx, q, vec, n, seed, 
+                                                 type_s(seed.size()), 
+                                                 idx, dst));
+      CHECK(idx == ans);
+    }
+
+  }
+
+}
@@ -0,0 +1,232 @@
+/*
+ * Filename: kdtree_nn.cpp
+ * Author:   Samridh D. Singh
+ * Date:     2025-02-01
+ *
+ * This file is part of sycl_kdtree.
+ *
+ * sycl_kdtree is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * sycl_kdtree is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with sycl_kdtree. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pch.h"
+
+#include <radius/radius.hpp>
+#include <radius/batch.hpp>
+#include <create/create.hpp>
+
+#include <random>
+#include <algorithm>
+
+template <typename C, typename T = typename C::value_type>
+static void
+generate_random_dataset(C& v, const T vmin, const T vmax) {
+  static std::mt19937 gen{std::random_device{}()};
+  if constexpr (std::is_floating_point_v<T>) {
+    std::uniform_real_distribution<T> dist(vmin, vmax);
+    for (auto& i : v) i = dist(gen);
+  } else {
+    std::uniform_int_distribution<T> dist(vmin, vmax);
+    for (auto& i : v) i = dist(gen);
+  }
+}
+
+namespace ref {
+
+template <typename F, typename T, T dim, kdtree::container::layout maj,
+          typename C_query, typename C_tree>
+static std::vector<T>
+radius(const C_query& q, const C_tree& tree, const T n, const F r) {
+  using kdtree::internal::dist::euclidian;
+  std::vector<T> out;
+  for (T i{0}; i < n; ++i) {
+    const F d{euclidian<F, T, dim, maj, C_query, maj, C_tree>(q, 1, 0, tree, 
+                                                              n, i)};
+    if (d <= r * r) out.push_back(i);
+  }
+  return out;
+}
+
+} // namespace ref
+
+template <typename type_v, std::size_t dim, kdtree::container::layout maj>
+static void
+test_radius_impl(const std::size_t n, const type_v vmax, const double r) {
+
+  using type_s = std::size_t;
+
+  kdtree::context ctx;
+
+  std::vector<type_v> vec(dim * n);
+  generate_random_dataset(vec, static_cast<type_v>(-vmax), vmax);
+  kdtree::create<type_s, dim, maj>(ctx, vec, n);
+
+  CAPTURE(n);
+  CAPTURE(r);
+
+  for (int i{0}; i < 16; ++i) {
+
+    std::vector<type_v> q(dim);
+    if (i % 4 == 0 && n > 0) {
+      for (type_s e{0}; e < dim; ++e) {
+        q[e] = kdtree::container::id<type_s, dim, maj>(vec, n, 
+                                                       type_s(i) % n, e);
+      }
+    } else {
+      generate_random_dataset(q, static_cast<type_v>(-vmax), vmax);
+    }
+
+    auto ans = ref::radius<double, type_s, dim, maj>(q, vec, n, r);
+
+    CHECK(kdtree::radius_count<double, type_s, dim, maj>(ctx, q, vec, n, r)
+          == ans.size());
+
+    // full collection.
+    {
+      std::vector<type_s> idx(n);
+      std::vector<double> dst(n);
+      const auto c = kdtree::radius_search<double, type_s, dim, maj>(
+        ctx, q, vec, n, r, idx, dst, type_s(n));
+      REQUIRE(c == ans.size());
+      idx.resize(c);
+      std::sort(idx.begin(), idx.end());
+      CHECK(idx == ans);
+    }
+
+    // truncated to half of the hits.
+    {
+      const type_s cap{ans.size() / 2};
+      std::vector<type_s> idx(cap + 1, n);
+      std::vector<double> dst(cap + 1, -1);
+      const auto c = kdtree::radius_search<double, type_s, dim, maj>(
+        ctx, q, vec, n, r, idx, dst, cap);
+      CHECK(c == ans.size());
+      for (type_s j{0}; j < cap; ++j) {
+        CHECK(std::binary_search(ans.begin(), ans.end(), idx[j]));
+        CHECK(dst[j] <= r * r);
+      }
+      CHECK(idx[cap] == n);
+    }
+
+  }
+
+}
+
+TEST_CASE("[random] kdtree::radius_search") {
+
+  constexpr auto row{kdtree::container::layout::row_major};
+  constexpr auto col{kdtree::container::layout::col_major};
+
+  test_radius_impl<int,    2, row>(1,    100,  10.0);
+  test_radius_impl<int,    2, row>(1000, 100,  10.0);
+  test_radius_impl<int,    3, col>(5000, 1000, 150.0);
+  test_radius_impl<int,    3, row>(5000, 1000, 0.0);
+  test_radius_impl<float,  3, row>(4096, 1.0f, 0.1);
+  test_radius_impl<double, 5, col>(2000, 1.0,  0.6);
+
+}
+
+TEST_CASE("[batch] kdtree::radius_batch") {
+
+  using type_v = float;
+  using type_s = uint32_t;
+  constexpr type_s dim{3};
+  constexpr auto   maj{kdtree::container::layout::row_major};
+
+  for (std::size_t nthreads : {1, 4}) {
+
+    kdtree::context ctx(nthreads);
+    ctx.euclidean = (nthreads > 1);
+
+    const type_s n{3000};
+    const type_s m{500};
+    const float  r{0.15f};
+
+    std::vector<type_v> vec(dim * n);
+    std::vector<type_v> qs(dim * m);
+    generate_random_dataset(vec, -1.0f, 1.0f);
+    generate_random_dataset(qs, -1.0f, 1.0f);
+    kdtree::create<type_s, dim, maj>(ctx, vec, n);
+
+    std::vector<type_s> off, idx;
+    std::vector<float>  dst;
+    kdtree::radius_batch<float, type_s, dim, maj>(ctx, qs, m, vec, n, r,
+                                                  off, idx, dst);
+
+    REQUIRE(off.size() == m + 1);
+    CHECK(off[0] == 0);
+    CHECK(idx.size() == off[m]);
+    CHECK(dst.size() == off[m]);
+
+    for (type_s i{0}; i < m; ++i) {
+      std::vector<type_v> q(qs.begin() + i * dim, qs.begin() + (i + 1) * dim);
+      const auto ans = ref::radius<float, type_s, dim, maj>(q, vec, n, r);
+      std::vector<type_s> row(idx.begin() + off[i], idx.begin() + off[i + 1]);
+      std::sort(row.begin(), row.end());
+      CHECK(row == ans);
+      for (type_s j{off[i]}; j < off[i + 1]; ++j) {
+        const float d{kdtree::internal::dist::euclidian<float, type_s, dim, 
+                      maj, decltype(q), maj, decltype(vec)>(q, 1, 0, vec, n,
+                                                            idx[j])};
+        CHECK(dst[j] == doctest::Approx(ctx.euclidean ? std::sqrt(d) : d));
+      }
+    }
+
+  }
+
+}
+
+TEST_CASE("[budget] kdtree::radius_count") {
+
+  using type_v = float;
+  using type_s = std::size_t;
+  constexpr type_s dim{3};
+  constexpr auto   maj{kdtree::container::layout::row_major};
+  constexpr type_s n{4096};
+  constexpr type_s m{64};
+  constexpr float  r{0.3f};
+
+  // a budget far below the hits of every query must not cut them short.
+  for (auto walk : {kdtree::walker::depth, kdtree::walker::best}) {
+
+    kdtree::context ctx;
+    ctx.budget = 8;
+    ctx.walk   = walk;
+
+    std::vector<type_v> vec(dim * n);
+    std::vector<type_v> qs(dim * m);
+    generate_random_dataset(vec, 0.0f, 1.0f);
+    generate_random_dataset(qs, 0.0f, 1.0f);
+    kdtree::create<type_s, dim, maj>(ctx, vec, n);
+
+    for (type_s i{0}; i < m; ++i) {
+      std::vector<type_v> q(qs.begin() + i * dim, qs.begin() + (i + 1) * dim);
+      const auto ans = ref::radius<float, type_s, dim, maj>(q, vec, n, r);
+      REQUIRE(ans.size() > ctx.budget);
+      CHECK(kdtree::radius_count<float, type_s, dim, maj>(ctx, q, vec, n, r)
+            == ans.size());
+    }
+
+    std::vector<type_s> off, idx;
+    std::vector<float>  dst;
+    kdtree::radius_batch<float, type_s, dim, maj>(ctx, qs, m, vec, n, r,
+                                                  off, idx, dst);
+    for (type_s i{0}; i < m; ++i) {
+      std::vector<type_v> q(qs.begin() + i * dim, qs.begin() + (i + 1) * dim);
+      const auto ans = ref::radius<float, type_s, dim, maj>(q, vec, n, r);
+      CHECK(off[i + 1] - off[i] == ans.size());
+    }
+
+  }
+
+}
@@ -21,6 +21,9 @@
 
 #include "pch.h"
 #include <sort/sort.hpp>
+#include <sort/select.hpp>
+#include <sort/sample.hpp>
+#include <sort/merge.hpp>
 
 #include <vector>
 #include <algorithm>
@@ -43,6 +46,40 @@ struct e1 {
 
 };
 
+// Payload exposing contiguous (key, index) arrays.
+template <typename K>
+struct e2 {
+  std::vector<K>        key;
+  std::vector<uint32_t> idx;
+
+  explicit e2(std::vector<K> v) : key(std::move(v)), idx(key.size()) {
+    for (std::size_t i = 0; i < idx.size(); ++i) idx[i] = uint32_t(i);
+  }
+
+  template <typename Ts>
+  bool less(Ts i_, Ts j_) { 
+    return key[i_] < key[j_]; 
+  }
+  
+  template <typename Ts>
+  void swap(Ts i_, Ts j_) { 
+    std::swap(key[i_], key[j_]); 
+    std::swap(idx[i_], idx[j_]); 
+  }
+};
+
+template <typename K>
+static void
+check_keyed(const e2<K>& arr, const std::vector<K>& original,
+            std::size_t n0, std::size_t n1) {
+  std::vector<K> expected = original;
+  std::sort(expected.begin() + long(n0), expected.begin() + long(n1));
+  REQUIRE(arr.key == expected);
+  for (std::size_t i = 0; i < arr.key.size(); ++i) {
+    REQUIRE(original[arr.idx[i]] == arr.key[i]);
+  }
+}
+
 TEST_CASE("[odd_even::sort]") {
   kdtree::context ctx;
   using U = std::size_t;
@@ -96,6 +133,51 @@ TEST_CASE("[odd_even::sort]") {
     REQUIRE(arr.v == expected);
   }
 
+  SUBCASE("Every 0-1 input up to 12 elements") {
+    for (std::size_t n = 0; n <= 12; ++n) {
+      for (std::size_t m = 0; m < (std::size_t{1} << n); ++m) {
+        e1<int> arr;
+        for (std::size_t i = 0; i < n; ++i) arr.v.push_back(int((m >> i) & 1));
+        kdtree::odd_even::sort(ctx, arr, U{0}, U{n});
+        REQUIRE(std::is_sorted(arr.v.begin(), arr.v.end()));
+      }
+    }
+  }
+
+  SUBCASE("Large sizes across the block boundary") {
+    kdtree::context ctx4(4);
+    for (std::size_t n : {4095ul, 4097ul, 12289ul, 100003ul}) {
+      CAPTURE(n);
+      e1<int> arr;
+      arr.v.resize(n + 2);
+      std::mt19937 rng{uint32_t(n)};
+      std::uniform_int_distribution<int> dist(-5000, 5000);
+      for (auto& x : arr.v) x = dist(rng);
+      auto expected = arr.v;
+      std::sort(expected.begin() + 1, expected.end() - 1);
+      kdtree::odd_even::sort(ctx4, arr, U{1}, U{n + 1});
+      REQUIRE(arr.v == expected);
+    }
+  }
+
+  SUBCASE("Stage comparators") {
+    // every slot either idles or orders a pair inside the array.
+    for (std::size_t n = 1; n < 200; ++n) {
+      for (std::size_t s = 1; s < n; s *= 2) {
+        for (std::size_t k = s; k > 0; k /= 2) {
+          const std::size_t m = kdtree::odd_even::slots(n, s, k);
+          for (std::size_t t = 0; t < m; ++t) {
+            std::size_t a, b;
+            if (kdtree::odd_even::comparator(n, s, k, t, a, b)) {
+              REQUIRE(a < b);
+              REQUIRE(b < n);
+            }
+          }
+        }
+      }
+    }
+  }
+
   SUBCASE("Empty subrange with offset") {
     e1<int> arr{ {8, 6, 7, 5, 3, 0, 9} };
     auto original = arr.v;
@@ -183,6 +265,27 @@ TEST_CASE("[sort]") {
     REQUIRE(arr.v == expected);
   }
 
+  SUBCASE("Non-power-of-two sizes and offset subranges") {
+    // these sizes are not powers of two, so kdtree::sort takes the odd-even
+    // network rather than bitonic::sort.
+    kdtree::context ctx4(4);
+    for (std::size_t n : {4095ul, 4097ul, 12289ul}) {
+      for (std::size_t off : {0ul, 3ul}) {
+        CAPTURE(n);
+        CAPTURE(off);
+        e1<int> arr;
+        arr.v.resize(n + 2 * off);
+        std::mt19937 rng{uint32_t(n + off)};
+        std::uniform_int_distribution<int> dist(-5000, 5000);
+        for (auto& x : arr.v) x = dist(rng);
+        auto expected = arr.v;
+        std::sort(expected.begin() + long(off), expected.end() - long(off));
+        kdtree::sort(ctx4, arr, U{off}, U{n + off});
+        REQUIRE(arr.v == expected);
+      }
+    }
+  }
+
   SUBCASE("Empty subrange with offset") {
     e1<int> arr{ {8, 6, 7, 5, 3, 0, 9} };
     auto original = arr.v;
@@ -278,3 +381,265 @@ TEST_CASE("[bitonic::sort]") {
     REQUIRE(arr.v == expected);
   }
 }
+
+TEST_CASE("[bitonic::sort] keyed payload") {
+  using U = std::size_t;
+  kdtree::context ctx(2);
+
+  // sizes around the vector widths, with keys that use the top bit.
+  for (std::size_t n : {1ul, 3ul, 8ul, 16ul, 17ul, 100ul, 1000ul, 4096ul,
+                        5000ul}) {
+    CAPTURE(n);
+
+    std::mt19937_64 rng(n);
+    std::vector<uint32_t> v32(n);
+    std::vector<uint64_t> v64(n);
+    for (auto& x : v32) x = uint32_t(rng()) | (rng() % 2 ? 0x80000000u : 0u);
+    for (auto& x : v64) x = rng() % 4 ? rng() : 0x8000000000000000ull;
+
+    e2<uint32_t> a32{ v32 };
+    kdtree::bitonic::sort(ctx, a32, U{0}, U{n});
+    check_keyed(a32, v32, 0, n);
+
+    e2<uint64_t> a64{ v64 };
+    kdtree::bitonic::sort(ctx, a64, U{0}, U{n});
+    check_keyed(a64, v64, 0, n);
+
+    if (n > 2) {
+      e2<uint32_t> sub{ v32 };
+      kdtree::bitonic::sort(ctx, sub, U{1}, U{n - 2});
+      check_keyed(sub, v32, 1, n - 2);
+    }
+  }
+}
+
+template <typename F>
+static void
+check_comparison_sort(F&& sort) {
+  using U = std::size_t;
+
+  for (std::size_t nthreads : {1, 4}) {
+
+    kdtree::context ctx(nthreads);
+    CAPTURE(nthreads);
+
+    SUBCASE("Empty and single element") {
+      e1<int> a{ {} };
+      sort(ctx, a, U{0}, U{0});
+      REQUIRE(a.v.empty());
+      e1<int> b{ {42} };
+      sort(ctx, b, U{0}, U{1});
+      REQUIRE(b.v == std::vector<int>{42});
+    }
+
+    for (std::size_t n : {17ul, 1000ul, 70000ul, 200000ul}) {
+      CAPTURE(n);
+      std::mt19937 rng{uint32_t(n)};
+
+      std::vector<int> rnd(n), few(n), asc(n), dsc(n);
+      std::uniform_int_distribution<int> wide(-1000000, 1000000);
+      std::uniform_int_distribution<int> narrow(0, 3);
+      for (std::size_t i = 0; i < n; ++i) {
+        rnd[i] = wide(rng);
+        few[i] = narrow(rng);
+        asc[i] = int(i);
+        dsc[i] = int(n - i);
+      }
+
+      for (auto* v : { &rnd, &few, &asc, &dsc }) {
+        e1<int> arr{ *v };
+        sort(ctx, arr, U{0}, U{n});
+        auto expected = *v;
+        std::sort(expected.begin(), expected.end());
+        REQUIRE(arr.v == expected);
+      }
+
+      e1<int> sub{ rnd };
+      sort(ctx, sub, U{3}, U{n - 5});
+      auto expected = rnd;
+      std::sort(expected.begin() + 3, expected.end() - 5);
+      REQUIRE(sub.v == expected);
+    }
+
+  }
+}
+
+TEST_CASE("[merge::sort]") {
+  check_comparison_sort([](auto& ctx, auto& p, auto n0, auto n1) {
+    kdtree::merge::sort(ctx, p, n0, n1);
+  });
+}
+
+TEST_CASE("[sample::sort]") {
+  check_comparison_sort([](auto& ctx, auto& p, auto n0, auto n1) {
+    kdtree::sample::sort(ctx, p, n0, n1);
+  });
+}
+
+TEST_CASE("[sort] sorter selection") {
+  using U = std::size_t;
+  for (auto s : {kdtree::sorter::sample, kdtree::sorter::merge}) {
+    kdtree::context ctx(3);
+    ctx.sort = s;
+    std::vector<uint32_t> v(50000);
+    std::mt19937 rng(52);
+    for (auto& x : v) x = rng();
+    e2<uint32_t> arr{ v };
+    kdtree::sort(ctx, arr, U{0}, U{v.size()});
+    check_keyed(arr, v, 0, v.size());
+  }
+}
+
+TEST_CASE("[radix::sort]") {
+  using U = std::size_t;
+
+  for (std::size_t nthreads : {1, 4}) {
+
+    kdtree::context ctx(nthreads);
+    CAPTURE(nthreads);
+
+    SUBCASE("Empty vector") {
+      e2<uint32_t> arr{ {} };
+      kdtree::radix::sort(ctx, arr, U{0}, U{0});
+      REQUIRE(arr.key.empty());
+    }
+
+    SUBCASE("Small vector") {
+      std::vector<uint32_t> v{ 9, 3, 7, 3, 1 };
+      e2<uint32_t> arr{ v };
+      kdtree::radix::sort(ctx, arr, U{0}, U{v.size()});
+      check_keyed(arr, v, 0, v.size());
+    }
+
+    SUBCASE("Large random dataset, 32-bit keys") {
+      std::vector<uint32_t> v(100000);
+      std::mt19937 rng(45);
+      std::uniform_int_distribution<uint32_t> dist;
+      for (auto& x : v) x = dist(rng);
+      e2<uint32_t> arr{ v };
+      kdtree::radix::sort(ctx, arr, U{0}, U{v.size()});
+      check_keyed(arr, v, 0, v.size());
+    }
+
+    SUBCASE("Large random dataset, shared high digits") {
+      std::vector<uint32_t> v(70000);
+      std::mt19937 rng(46);
+      std::uniform_int_distribution<uint32_t> dist(0x3f800000u, 0x3f80ffffu);
+      for (auto& x : v) x = dist(rng);
+      e2<uint32_t> arr{ v };
+      kdtree::radix::sort(ctx, arr, U{0}, U{v.size()});
+      check_keyed(arr, v, 0, v.size());
+    }
+
+    SUBCASE("Subrange, 64-bit keys") {
+      std::vector<uint64_t> v(50000);
+      std::mt19937_64 rng(47);
+      std::uniform_int_distribution<uint64_t> dist;
+      for (auto& x : v) x = dist(rng);
+      e2<uint64_t> arr{ v };
+      kdtree::radix::sort(ctx, arr, U{1234}, U{40000});
+      check_keyed(arr, v, 1234, 40000);
+    }
+
+    SUBCASE("Selected through kdtree::sort") {
+      std::vector<uint32_t> v(5000);
+      std::mt19937 rng(48);
+      std::uniform_int_distribution<uint32_t> dist(0, 100);
+      for (auto& x : v) x = dist(rng);
+      e2<uint32_t> arr{ v };
+      ctx.sort = kdtree::sorter::radix;
+      kdtree::sort(ctx, arr, U{0}, U{v.size()});
+      check_keyed(arr, v, 0, v.size());
+    }
+
+  }
+}
+
+template <typename T>
+static void
+check_select(const std::vector<T>& v, const std::vector<T>& original,
+             std::size_t n0, std::size_t nk, std::size_t n1) {
+  std::vector<T> expected = original;
+  std::sort(expected.begin() + long(n0), expected.begin() + long(n1));
+  REQUIRE(v[nk] == expected[nk]);
+  for (std::size_t i = n0; i < nk; ++i) REQUIRE(v[i] <= v[nk]);
+  for (std::size_t i = nk; i < n1; ++i) REQUIRE(v[i] >= v[nk]);
+  for (std::size_t i = 0; i < n0; ++i)  REQUIRE(v[i] == original[i]);
+  for (std::size_t i = n1; i < v.size(); ++i) REQUIRE(v[i] == original[i]);
+  std::vector<T> a(v), b(original);
+  std::sort(a.begin(), a.end());
+  std::sort(b.begin(), b.end());
+  REQUIRE(a == b);
+}
+
+TEST_CASE("[select]") {
+  using U = std::size_t;
+
+  // ranges of 8192 elements or more are partitioned on the pool when it
+  // has threads.
+
+  for (std::size_t nthreads : {1, 4}) {
+
+    kdtree::context ctx(nthreads);
+    CAPTURE(nthreads);
+
+    SUBCASE("Every rank of a small vector") {
+      std::vector<int> v{ 5, 1, 4, 1, 5, 9, 2, 6, 5, 3, 5 };
+      for (std::size_t k = 0; k < v.size(); ++k) {
+        e1<int> arr{ v };
+        kdtree::select(ctx, arr, U{0}, U{k}, U{v.size()});
+        check_select(arr.v, v, 0, k, v.size());
+      }
+    }
+
+    SUBCASE("Large random dataset") {
+      std::vector<int> v(100000);
+      std::mt19937 rng(49);
+      std::uniform_int_distribution<int> dist(-1000000, 1000000);
+      for (auto& x : v) x = dist(rng);
+      for (std::size_t k : {0ul, 1ul, 4096ul, 50000ul, 99999ul}) {
+        e1<int> arr{ v };
+        kdtree::select(ctx, arr, U{0}, U{k}, U{v.size()});
+        check_select(arr.v, v, 0, k, v.size());
+      }
+    }
+
+    SUBCASE("Duplicates, sorted and reversed input") {
+      std::vector<int> same(20000, 7);
+      std::vector<int> asc(20000), dsc(20000);
+      for (std::size_t i = 0; i < asc.size(); ++i) {
+        asc[i] = int(i);
+        dsc[i] = int(asc.size() - i);
+      }
+      std::vector<int> few(20000);
+      std::mt19937 rng(50);
+      std::uniform_int_distribution<int> dist(0, 3);
+      for (auto& x : few) x = dist(rng);
+      for (auto* v : { &same, &asc, &dsc, &few }) {
+        e1<int> arr{ *v };
+        kdtree::select(ctx, arr, U{0}, U{9999}, U{v->size()});
+        check_select(arr.v, *v, 0, 9999, v->size());
+      }
+    }
+
+    SUBCASE("Subrange with keyed payload") {
+      std::vector<uint32_t> v(30000);
+      std::mt19937 rng(51);
+      std::uniform_int_distribution<uint32_t> dist;
+      for (auto& x : v) x = dist(rng);
+      e2<uint32_t> arr{ v };
+      kdtree::select(ctx, arr, U{1000}, U{12345}, U{25000});
+      check_select(arr.key, v, 1000, 12345, 25000);
+      for (std::size_t i = 0; i < arr.key.size(); ++i) {
+        REQUIRE(v[arr.idx[i]] == arr.key[i]);
+      }
+    }
+
+    SUBCASE("Rank outside the range") {
+      e1<int> arr{ { 3, 2, 1 } };
+      REQUIRE_THROWS_AS(kdtree::select(ctx, arr, U{0}, U{3}, U{3}),
+                        std::out_of_range);
+    }
+
+  }
+}